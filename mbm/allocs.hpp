@@ -0,0 +1,220 @@
+// =====================================================================================
+// 
+//       Filename:  allocs.hpp
+// 
+//    Description:  Allocation and page fault counts for timed runs
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 09:02:44 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_ALLOCS_HPP_
+#define MBM_ALLOCS_HPP_
+
+#include <sys/resource.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace mbm {
+    enum alloc_id {
+        alloc_allocs,
+        alloc_frees,
+        alloc_bytes,
+        alloc_minor_faults,
+        alloc_major_faults,
+        alloc_count
+    };
+
+    inline const char * alloc_name(alloc_id id) {
+        static const char * names[alloc_count] = { "allocs", "frees", "alloc-bytes", "minor-faults", "major-faults" };
+        return names[id];
+    }
+
+    // Sums over all runs of a fixture (or table row). Allocation counts need
+    // the hooks, page faults come from getrusage and are always available.
+    struct alloc_totals {
+        std::array<uint64_t, alloc_count> values;
+        uint64_t runs;
+        bool hooked;
+
+        alloc_totals() : runs(0), hooked(false) { values.fill(0); }
+
+        bool empty() const { return !runs; }
+        bool has(alloc_id id) const { return !empty() && (hooked || id >= alloc_minor_faults); }
+        double per_run(alloc_id id) const { return runs ? static_cast<double>(values[id]) / runs : 0.0; }
+    };
+
+    namespace detail {
+        struct alloc_state {
+            bool active;
+            uint64_t allocs;
+            uint64_t frees;
+            uint64_t bytes;
+        };
+
+        // Trivial, so the hooks can use it before main and on new threads
+        // without allocating
+        inline alloc_state & alloc_local() {
+            static thread_local alloc_state state;
+            return state;
+        }
+
+        inline bool & alloc_hooked() {
+            static bool hooked = false;
+            return hooked;
+        }
+
+        inline void count_alloc(size_t n) {
+            auto & s = alloc_local();
+            if (!s.active) return;
+            s.allocs++;
+            s.bytes += n;
+        }
+
+        inline void count_free(void * p) {
+            auto & s = alloc_local();
+            if (s.active && p) s.frees++;
+        }
+    }
+
+    // True when one translation unit was compiled with MBM_ALLOC_HOOKS
+    inline bool alloc_hooks() { return detail::alloc_hooked(); }
+
+    // Counts the calling thread's allocations between start() and stop(),
+    // the hooks only do work while a tracker is started
+    class alloc_tracker {
+    public:
+        void start() {
+            auto & s = detail::alloc_local();
+            allocs_ = s.allocs;
+            frees_ = s.frees;
+            bytes_ = s.bytes;
+            getrusage(RUSAGE_THREAD, &usage_);
+            s.active = true;
+        }
+
+        void stop(alloc_totals & totals) {
+            auto & s = detail::alloc_local();
+            s.active = false;
+            rusage usage;
+            getrusage(RUSAGE_THREAD, &usage);
+            totals.hooked = alloc_hooks();
+            totals.values[alloc_allocs] += s.allocs - allocs_;
+            totals.values[alloc_frees] += s.frees - frees_;
+            totals.values[alloc_bytes] += s.bytes - bytes_;
+            totals.values[alloc_minor_faults] += usage.ru_minflt - usage_.ru_minflt;
+            totals.values[alloc_major_faults] += usage.ru_majflt - usage_.ru_majflt;
+            totals.runs++;
+        }
+
+    private:
+        uint64_t allocs_;
+        uint64_t frees_;
+        uint64_t bytes_;
+        rusage usage_;
+    };
+}
+
+// Define in exactly one translation unit of the benchmark executable to
+// replace operator new/delete and interpose the glibc malloc family. Without
+// it nothing is replaced and --allocs reports page faults only.
+#ifdef MBM_ALLOC_HOOKS
+extern "C" {
+    void * __libc_malloc(size_t);
+    void * __libc_calloc(size_t, size_t);
+    void * __libc_realloc(void *, size_t);
+    void * __libc_memalign(size_t, size_t);
+    void __libc_free(void *);
+
+    void * malloc(size_t n) {
+        mbm::detail::count_alloc(n);
+        return __libc_malloc(n);
+    }
+
+    void * calloc(size_t count, size_t n) {
+        mbm::detail::count_alloc(count * n);
+        return __libc_calloc(count, n);
+    }
+
+    void * realloc(void * p, size_t n) {
+        mbm::detail::count_free(p);
+        mbm::detail::count_alloc(n);
+        return __libc_realloc(p, n);
+    }
+
+    void * memalign(size_t align, size_t n) {
+        mbm::detail::count_alloc(n);
+        return __libc_memalign(align, n);
+    }
+
+    void * aligned_alloc(size_t align, size_t n) {
+        mbm::detail::count_alloc(n);
+        return __libc_memalign(align, n);
+    }
+
+    int posix_memalign(void ** p, size_t align, size_t n) {
+        mbm::detail::count_alloc(n);
+        *p = __libc_memalign(align, n);
+        return *p ? 0 : ENOMEM;
+    }
+
+    void free(void * p) {
+        mbm::detail::count_free(p);
+        __libc_free(p);
+    }
+}
+
+namespace mbm {
+    namespace detail {
+        static const bool alloc_hooks_installed = (alloc_hooked() = true);
+    }
+}
+
+// Counted once here, the malloc they forward to is not counted again
+void * operator new(size_t n) {
+    mbm::detail::count_alloc(n);
+    if (auto p = __libc_malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void * operator new[](size_t n) { return operator new(n); }
+
+void * operator new(size_t n, const std::nothrow_t &) noexcept {
+    mbm::detail::count_alloc(n);
+    return __libc_malloc(n ? n : 1);
+}
+
+void * operator new[](size_t n, const std::nothrow_t & tag) noexcept { return operator new(n, tag); }
+
+void operator delete(void * p) noexcept {
+    mbm::detail::count_free(p);
+    __libc_free(p);
+}
+
+void operator delete[](void * p) noexcept { operator delete(p); }
+void operator delete(void * p, const std::nothrow_t &) noexcept { operator delete(p); }
+void operator delete[](void * p, const std::nothrow_t &) noexcept { operator delete(p); }
+#endif
+
+#endif // MBM_ALLOCS_HPP_
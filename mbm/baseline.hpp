@@ -0,0 +1,117 @@
+// =====================================================================================
+// 
+//       Filename:  baseline.hpp
+// 
+//    Description:  Saved baseline results for regression checks
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 04:12:40 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_BASELINE_HPP_
+#define MBM_BASELINE_HPP_
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mbm {
+namespace baseline {
+    // One line per fixture and table parameter, tab separated:
+    //   group  fixture  param  items  n  sample...
+    // Samples are per call nanoseconds so a file stays meaningful across
+    // TSC recalibrations, items the work per call the fixture declared (0
+    // for none). v1 files have no items column.
+    const char * const magic = "# mbm baseline v2";
+    const char * const magic_v1 = "# mbm baseline v1";
+
+    typedef std::tuple<std::string, std::string, std::string> key_t;   // group, fixture, param
+
+    struct entry {
+        double items;
+        std::vector<double> samples;
+    };
+
+    typedef std::map<key_t, entry> results_t;
+
+    inline void check_field(const std::string & field) {
+        if (field.find_first_of("\t\n") != std::string::npos)
+            throw std::runtime_error("baseline names must not contain tabs or newlines: " + field);
+    }
+
+    inline void save(const std::string & path, const results_t & results) {
+        std::ofstream stm(path);
+        if (!stm) throw std::runtime_error("unable to open " + path);
+        stm << magic << '\n' << std::setprecision(9);
+        for (const auto & r : results) {
+            check_field(std::get<0>(r.first));
+            check_field(std::get<1>(r.first));
+            check_field(std::get<2>(r.first));
+            stm << std::get<0>(r.first) << '\t' << std::get<1>(r.first) << '\t' << std::get<2>(r.first) 
+                << '\t' << r.second.items << '\t' << r.second.samples.size();
+            for (auto s : r.second.samples) stm << ' ' << s;
+            stm << '\n';
+        }
+        if (!stm) throw std::runtime_error("error writing " + path);
+    }
+
+    inline results_t load(const std::string & path) {
+        std::ifstream stm(path);
+        if (!stm) throw std::runtime_error("unable to open " + path);
+        std::string line;
+        if (!std::getline(stm, line) || (line != magic && line != magic_v1))
+            throw std::runtime_error(path + " is not an mbm baseline file");
+        auto has_items = line == magic;
+
+        results_t res;
+        for (unsigned lineno = 2; std::getline(stm, line); lineno++) {
+            if (line.empty()) continue;
+            std::istringstream fields(line);
+            std::string group, name, param;
+            size_t n = 0;
+            std::getline(fields, group, '\t');
+            std::getline(fields, name, '\t');
+            std::getline(fields, param, '\t');
+            double items = 0.0;
+            if (has_items) fields >> items;
+            std::vector<double> samples;
+            if (fields >> n) {
+                samples.reserve(n);
+                double s;
+                while (samples.size() < n && fields >> s) samples.push_back(s);
+            }
+            if (!fields || samples.size() != n || !n) {
+                std::ostringstream err;
+                err << path << ":" << lineno << ": malformed baseline entry";
+                throw std::runtime_error(err.str());
+            }
+            res[key_t(group, name, param)] = entry { items, std::move(samples) };
+        }
+        return res;
+    }
+}
+}
+
+#endif // MBM_BASELINE_HPP_
@@ -0,0 +1,146 @@
+// =====================================================================================
+// 
+//       Filename:  cache.hpp
+// 
+//    Description:  Cache and TLB eviction for cold runs
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 09:31:08 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_CACHE_HPP_
+#define MBM_CACHE_HPP_
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace mbm {
+    enum cache_mode { cache_warm, cache_cold, cache_both };
+
+    inline const char * name(cache_mode m) {
+        static const char * names[] = { "warm", "cold", "both" };
+        return names[m];
+    }
+
+    inline bool parse(const std::string & str, cache_mode & res) {
+        if (str == "warm") res = cache_warm;
+        else if (str == "cold") res = cache_cold;
+        else if (str == "both") res = cache_both;
+        else return false;
+        return true;
+    }
+
+    // Memory a fixture's go() reads, flushed line by line before a cold run
+    struct mem_range {
+        const void * data;
+        size_t size;
+    };
+
+    namespace detail {
+        // A sysfs cache attribute of cpu0, empty if the file is missing
+        inline std::string sysfs_cache(unsigned index, const std::string & attr) {
+            std::ifstream stm("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/" + attr);
+            std::string res;
+            std::getline(stm, res);
+            return res;
+        }
+
+        // "32768K" or "8M"
+        inline size_t parse_size(const std::string & str) {
+            char * end;
+            auto res = std::strtoull(str.c_str(), &end, 10);
+            if (*end == 'K') res <<= 10;
+            else if (*end == 'M') res <<= 20;
+            return res;
+        }
+    }
+
+    inline size_t cache_line_size() {
+        auto res = detail::parse_size(detail::sysfs_cache(0, "coherency_line_size"));
+        return res ? res : 64;
+    }
+
+    // Size of the highest level cache of cpu0, 32MB if the topology is unknown
+    inline size_t llc_size() {
+        size_t res = 0;
+        unsigned level = 0;
+        for (unsigned i = 0; ; i++) {
+            auto l = detail::sysfs_cache(i, "level");
+            if (l.empty()) break;
+            auto n = std::strtoul(l.c_str(), nullptr, 10);
+            if (n < level || detail::sysfs_cache(i, "type") == "Instruction") continue;
+            level = n;
+            res = detail::parse_size(detail::sysfs_cache(i, "size"));
+        }
+        return res ? res : size_t(32) << 20;
+    }
+
+    // Evicts the caches, and the TLB with them, between setup() and go().
+    // Registered ranges are flushed with clflush; otherwise a buffer of
+    // sweep_factor times the last level cache is read a line at a time,
+    // which also walks more pages than the TLB holds. Adaptive, non-LRU
+    // replacement keeps lines through a sweep of just the cache size; even
+    // this one evicts most lines, not provably all.
+    class cache_evictor {
+    public:
+        static const size_t sweep_factor = 2;
+
+        explicit cache_evictor(size_t size = sweep_factor * llc_size()) : line_(cache_line_size()), buf_(size, 1) { }
+
+        size_t size() const { return buf_.size(); }
+
+        void evict(const std::vector<mem_range> & ranges) const {
+            if (ranges.empty()) {
+                sweep();
+                return;
+            }
+            for (const auto & r : ranges) flush(r);
+            __asm__ __volatile__("mfence" ::: "memory");
+        }
+
+        void sweep() const {
+            unsigned char sum = 0;
+            for (size_t i = 0; i < buf_.size(); i += line_) sum += buf_[i];
+            __asm__ __volatile__("" :: "r"(sum));
+        }
+
+        void flush(const mem_range & r) const {
+            auto p = reinterpret_cast<uintptr_t>(r.data) & ~(uintptr_t(line_) - 1);
+            auto end = reinterpret_cast<uintptr_t>(r.data) + r.size;
+            for (; p < end; p += line_)
+                __asm__ __volatile__("clflush (%0)" :: "r"(p) : "memory");
+        }
+
+    private:
+        size_t line_;
+        std::vector<unsigned char> buf_;
+    };
+
+    // One sweep buffer for the process, allocated on first use
+    inline cache_evictor & shared_evictor() {
+        static cache_evictor res;
+        return res;
+    }
+}
+
+#endif // MBM_CACHE_HPP_
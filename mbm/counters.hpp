@@ -0,0 +1,256 @@
+// =====================================================================================
+// 
+//       Filename:  counters.hpp
+// 
+//    Description:  Hardware performance counters via perf_event_open
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 09:12:40 AM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_COUNTERS_HPP_
+#define MBM_COUNTERS_HPP_
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mbm {
+    enum counter_id {
+        ctr_cycles,
+        ctr_instructions,
+        ctr_l1d_misses,
+        ctr_llc_misses,
+        ctr_branch_misses,
+        ctr_dtlb_misses,
+        ctr_count
+    };
+
+    struct counter_def {
+        const char * name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+    inline const counter_def & counter_info(counter_id id) {
+        static const counter_def defs[ctr_count] = {
+            { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { "l1d-miss", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+            { "llc-miss", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+            { "br-miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            { "dtlb-miss", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) }
+        };
+        return defs[id];
+    }
+
+    // Scaled counter sums over all runs of a fixture (or table row)
+    struct counter_totals {
+        std::array<double, ctr_count> values;
+        std::array<bool, ctr_count> valid;
+        uint64_t runs;
+        uint64_t multiplexed;
+        uint64_t unscheduled;
+
+        counter_totals() : runs(0), multiplexed(0), unscheduled(0) {
+            values.fill(0.0);
+            valid.fill(false);
+        }
+
+        bool empty() const { return runs == unscheduled; }
+        bool has(counter_id id) const { return valid[id] && !empty(); }
+
+        double per_run(counter_id id) const {
+            return has(id) ? values[id] / (runs - unscheduled) : 0.0;
+        }
+
+        double ipc() const {
+            auto cycles = per_run(ctr_cycles);
+            return cycles > 0.0 ? per_run(ctr_instructions) / cycles : 0.0;
+        }
+    };
+
+    inline int perf_event_paranoid() {
+        std::ifstream stm("/proc/sys/kernel/perf_event_paranoid");
+        int res = std::numeric_limits<int>::min();
+        stm >> res;
+        return res;
+    }
+
+    // A group of user-space-only counters led by the cycle counter. The
+    // group is enabled and disabled with a single ioctl so all members cover
+    // exactly the same region. Events the PMU cannot provide are dropped at
+    // open time; if the kernel time-slices the group with other users,
+    // deltas are scaled by time_enabled / time_running.
+    class counter_group {
+    public:
+        counter_group() : leader_(-1), prev_enabled_(0), prev_running_(0) {
+            overhead_.fill(0.0);
+            for (auto i = 0; i < ctr_count; i++) {
+                auto id = static_cast<counter_id>(i);
+                auto fd = open_event(counter_info(id), leader_);
+                if (fd < 0) {
+                    if (leader_ < 0) {
+                        std::ostringstream stm;
+                        stm << "perf_event_open: " << strerror(errno);
+                        if (errno == EACCES || errno == EPERM)
+                            stm << " (perf_event_paranoid=" << perf_event_paranoid() << ")";
+                        error_ = stm.str();
+                        return;
+                    }
+                    continue;
+                }
+                if (leader_ < 0) leader_ = fd;
+                fds_.push_back(fd);
+                ids_.push_back(id);
+            }
+            prev_.assign(fds_.size(), 0);
+            snapshot(prev_, prev_enabled_, prev_running_);
+            calibrate();
+        }
+
+        counter_group(const counter_group &) = delete;
+        counter_group & operator=(const counter_group &) = delete;
+
+        ~counter_group() {
+            for (auto fd : fds_) close(fd);
+        }
+
+        bool ok() const { return leader_ >= 0; }
+        const std::string & error() const { return error_; }
+
+        void start() {
+            ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+
+        void stop(counter_totals & totals) {
+            ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+            std::array<double, ctr_count> deltas;
+            auto scheduled = read_deltas(deltas, totals);
+            totals.runs++;
+            if (!scheduled) {
+                totals.unscheduled++;
+                return;
+            }
+            for (auto i = 0u; i < ids_.size(); i++) {
+                auto id = ids_[i];
+                auto v = deltas[id] - overhead_[id];
+                totals.values[id] += v > 0.0 ? v : 0.0;
+                totals.valid[id] = true;
+            }
+        }
+
+    private:
+        static long perf_event_open(perf_event_attr * attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+            return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+        }
+
+        static int open_event(const counter_def & def, int leader) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = def.type;
+            attr.config = def.config;
+            attr.disabled = leader < 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | 
+                PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(perf_event_open(&attr, 0, -1, leader, 0));
+        }
+
+        bool snapshot(std::vector<uint64_t> & values, uint64_t & enabled, uint64_t & running) const {
+            // nr, time_enabled, time_running, value[nr]
+            std::array<uint64_t, 3 + ctr_count> buf;
+            auto n = read(leader_, buf.data(), sizeof(buf));
+            if (n < static_cast<ssize_t>((3 + fds_.size()) * sizeof(uint64_t)))
+                return false;
+            enabled = buf[1];
+            running = buf[2];
+            std::copy(buf.begin() + 3, buf.begin() + 3 + values.size(), values.begin());
+            return true;
+        }
+
+        // Returns false if the group was not on the PMU at all during the run
+        bool read_deltas(std::array<double, ctr_count> & deltas, counter_totals & totals) {
+            std::vector<uint64_t> cur(fds_.size());
+            uint64_t enabled, running;
+            if (!snapshot(cur, enabled, running)) return false;
+
+            auto d_enabled = enabled - prev_enabled_;
+            auto d_running = running - prev_running_;
+            auto scale = d_running ? static_cast<double>(d_enabled) / d_running : 0.0;
+            if (d_running && d_running < d_enabled) totals.multiplexed++;
+
+            deltas.fill(0.0);
+            for (auto i = 0u; i < cur.size(); i++)
+                deltas[ids_[i]] = (cur[i] - prev_[i]) * scale;
+
+            prev_.swap(cur);
+            prev_enabled_ = enabled;
+            prev_running_ = running;
+            return d_running != 0;
+        }
+
+        // The enable/disable ioctls leave a few user-space instructions
+        // inside the counted region; measure and subtract them like the TSC
+        // loop overhead.
+        void calibrate() {
+            overhead_.fill(std::numeric_limits<double>::max());
+            for (auto i = 0; i < 64; i++) {
+                counter_totals scratch;
+                std::array<double, ctr_count> deltas;
+                start();
+                ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+                if (!read_deltas(deltas, scratch)) continue;
+                for (auto id : ids_)
+                    overhead_[id] = std::min(overhead_[id], deltas[id]);
+            }
+            for (auto & v : overhead_)
+                if (v == std::numeric_limits<double>::max()) v = 0.0;
+        }
+
+        int leader_;
+        std::string error_;
+        std::vector<int> fds_;
+        std::vector<counter_id> ids_;
+        std::vector<uint64_t> prev_;
+        uint64_t prev_enabled_;
+        uint64_t prev_running_;
+        std::array<double, ctr_count> overhead_;
+    };
+}
+#endif // MBM_COUNTERS_HPP_
@@ -0,0 +1,259 @@
+// =====================================================================================
+// 
+//       Filename:  dataset.hpp
+// 
+//    Description:  Shared read-only datasets for fixtures
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 09:14:07 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_DATASET_HPP_
+#define MBM_DATASET_HPP_
+
+#include <boost/utility/string_view.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mbm {
+    // C++11 has no std::string_view
+    typedef boost::string_view string_view;
+
+    // A read-only view of contiguous T owned elsewhere
+    template<typename T>
+    class span {
+    public:
+        typedef T value_type;
+        typedef const T * iterator;
+        typedef const T * const_iterator;
+
+        span() : data_(nullptr), size_(0) { }
+        span(const T * data, size_t size) : data_(data), size_(size) { }
+        explicit span(const std::vector<T> & v) : data_(v.data()), size_(v.size()) { }
+
+        const T * begin() const { return data_; }
+        const T * end() const { return data_ + size_; }
+        const T * data() const { return data_; }
+        size_t size() const { return size_; }
+        bool empty() const { return !size_; }
+        const T & operator[](size_t i) const { return data_[i]; }
+
+    private:
+        const T * data_;
+        size_t size_;
+    };
+
+    // The lines of a text file, read into one arena and viewed in place.
+    // Moving keeps the views valid, so it is move only.
+    class text {
+    public:
+        text() = default;
+        text(text &&) = default;
+        text & operator=(text &&) = default;
+        text(const text &) = delete;
+        text & operator=(const text &) = delete;
+
+        span<string_view> lines() const { return span<string_view>(lines_); }
+        size_t bytes() const { return arena_.size(); }
+
+        friend text read_lines(const std::string & fname);
+
+    private:
+        std::vector<char> arena_;
+        std::vector<string_view> lines_;
+    };
+
+    inline text read_lines(const std::string & fname) {
+        std::ifstream stm(fname, std::ios::binary | std::ios::ate);
+        if (!stm) throw std::runtime_error("unable to open " + fname);
+        text res;
+        res.arena_.resize(static_cast<size_t>(stm.tellg()));
+        stm.seekg(0);
+        if (!stm.read(res.arena_.data(), res.arena_.size())) throw std::runtime_error("unable to read " + fname);
+
+        const char * end = res.arena_.data() + res.arena_.size();
+        for (const char * p = res.arena_.data(); p != end; ) {
+            auto eol = std::find(p, end, '\n');
+            size_t n = eol - p;
+            if (n && p[n - 1] == '\r') n--;
+            res.lines_.emplace_back(p, n);
+            p = eol == end ? end : eol + 1;
+        }
+        return res;
+    }
+
+    namespace detail {
+        // A registered dataset, loaded on first use. While fixtures that
+        // declared it are still to run it is pinned, so it is loaded once
+        // and freed after the last of them, once no fixture holds it.
+        class dataset_slot {
+        public:
+            explicit dataset_slot(const std::string & name) : users_(0), name_(name) { }
+            virtual ~dataset_slot() { }
+
+            const std::string & name() const { return name_; }
+            virtual void load() = 0;
+
+            void acquire() {
+                std::lock_guard<std::mutex> lock(m_);
+                users_++;
+            }
+
+            void release() {
+                std::lock_guard<std::mutex> lock(m_);
+                if (users_ && !--users_) unpin();
+            }
+
+        protected:
+            std::mutex m_;
+            unsigned users_;
+
+            virtual void unpin() = 0;
+
+        private:
+            std::string name_;
+        };
+
+        template<typename T>
+        class typed_slot : public dataset_slot {
+        public:
+            typed_slot(const std::string & name, std::function<T()> loader) : 
+                dataset_slot(name), loader_(std::move(loader)) { }
+
+            std::shared_ptr<const T> get() {
+                std::lock_guard<std::mutex> lock(m_);
+                auto res = loaded_.lock();
+                if (!res) {
+                    try {
+                        res = std::make_shared<const T>(loader_());
+                    } catch (const std::exception & e) {
+                        throw std::runtime_error("dataset " + name() + ": " + e.what());
+                    }
+                    loaded_ = res;
+                }
+                if (users_) pinned_ = res;
+                return res;
+            }
+
+            virtual void load() { get(); }
+
+        private:
+            std::function<T()> loader_;
+            std::weak_ptr<const T> loaded_;
+            std::shared_ptr<const T> pinned_;
+
+            virtual void unpin() { pinned_.reset(); }
+        };
+
+        typedef std::vector<std::shared_ptr<dataset_slot>> dataset_slots_t;
+
+        // Pins the datasets of the fixtures still to run, releasing each
+        // fixture's as it finishes and any left over on the way out
+        class dataset_pins {
+        public:
+            dataset_pins() = default;
+            dataset_pins(const dataset_pins &) = delete;
+            dataset_pins & operator=(const dataset_pins &) = delete;
+
+            ~dataset_pins() {
+                for (auto & slot : held_) slot->release();
+            }
+
+            void acquire(const dataset_slots_t & slots) {
+                for (auto & slot : slots) {
+                    slot->acquire();
+                    held_.push_back(slot);
+                }
+            }
+
+            void release(const dataset_slots_t & slots) {
+                for (auto & slot : slots) {
+                    auto it = std::find(std::begin(held_), std::end(held_), slot);
+                    if (it == std::end(held_)) continue;
+                    held_.erase(it);
+                    slot->release();
+                }
+            }
+
+        private:
+            dataset_slots_t held_;
+        };
+    }
+
+    // A handle to a registered dataset, cheap to copy into factories. get()
+    // loads it on first use, the pointer it returns keeps it alive.
+    template<typename T>
+    class dataset {
+    public:
+        typedef std::shared_ptr<const T> pointer;
+
+        dataset() = default;
+        explicit dataset(std::shared_ptr<detail::typed_slot<T>> slot) : slot_(std::move(slot)) { }
+
+        pointer get() const { 
+            if (!slot_) throw std::runtime_error("dataset not registered");
+            return slot_->get(); 
+        }
+
+        std::string name() const { return slot_ ? slot_->name() : std::string(); }
+        std::shared_ptr<detail::dataset_slot> slot() const { return slot_; }
+
+    private:
+        std::shared_ptr<detail::typed_slot<T>> slot_;
+    };
+
+    // Datasets by name, each made by its loader when a fixture first asks for it
+    class dataset_registry {
+    public:
+        template<typename F>
+        dataset<typename std::decay<typename std::result_of<F()>::type>::type> 
+        add(const std::string & name, F loader) {
+            typedef typename std::decay<typename std::result_of<F()>::type>::type T;
+            if (slots_.count(name)) throw std::runtime_error("dataset " + name + " already registered");
+            auto slot = std::make_shared<detail::typed_slot<T>>(name, std::function<T()>(std::move(loader)));
+            slots_[name] = slot;
+            return dataset<T>(slot);
+        }
+
+        template<typename T>
+        dataset<T> find(const std::string & name) const {
+            auto it = slots_.find(name);
+            std::shared_ptr<detail::typed_slot<T>> slot;
+            if (it != std::end(slots_)) slot = std::dynamic_pointer_cast<detail::typed_slot<T>>(it->second);
+            if (!slot) throw std::runtime_error("no dataset " + name + " of that type");
+            return dataset<T>(slot);
+        }
+
+    private:
+        std::map<std::string, std::shared_ptr<detail::dataset_slot>> slots_;
+    };
+}
+
+#endif // MBM_DATASET_HPP_
@@ -0,0 +1,200 @@
+// =====================================================================================
+// 
+//       Filename:  environment.hpp
+// 
+//    Description:  Run environment capture and noise checks
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 09:58:21 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_ENVIRONMENT_HPP_
+#define MBM_ENVIRONMENT_HPP_
+
+#include "measure.hpp"
+#include "threads.hpp"
+
+#include <sys/utsname.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mbm {
+    // The machine a run was measured on. Unknown settings are empty strings
+    // or -1, and are never reported as problems.
+    struct environment {
+        std::string cpu;
+        uint32_t base_mhz;      // CPUID leaf 0x16, 0 if not reported
+        unsigned cpus;
+        int smt;                // simultaneous multithreading active
+        int turbo;
+        std::string governor;   // of the pinned core
+        int isolated;           // pinned core in isolcpus
+        double irq_rate;        // device interrupts per second on the pinned core, local timer excluded
+        std::string kernel;
+        std::string compiler;
+        std::string flags;
+
+        environment() : base_mhz(0), cpus(0), smt(-1), turbo(-1), isolated(-1), irq_rate(-1.0) { }
+
+        // Settings that make results noisy or not comparable
+        std::vector<std::string> problems(double irq_limit) const {
+            std::vector<std::string> res;
+            if (!governor.empty() && governor != "performance")
+                res.push_back("frequency governor is " + governor + ", not performance");
+            if (turbo == 1)
+                res.push_back("turbo is on");
+            if (irq_limit > 0.0 && irq_rate > irq_limit) {
+                std::ostringstream stm;
+                stm << "pinned core handles " << static_cast<uint64_t>(irq_rate) << " interrupts/s";
+                res.push_back(stm.str());
+            }
+            return res;
+        }
+    };
+
+    namespace detail {
+        inline std::string sysfs_line(const std::string & path) {
+            std::ifstream stm(path);
+            std::string res;
+            std::getline(stm, res);
+            return res;
+        }
+
+        inline int sysfs_flag(const std::string & path) {
+            auto line = sysfs_line(path);
+            return line.empty() ? -1 : line != "0";
+        }
+
+        // Interrupts on cpu since boot per /proc/interrupts, skipping the
+        // local timer
+        inline uint64_t cpu_interrupts(unsigned cpu) {
+            std::ifstream stm("/proc/interrupts");
+            std::string line;
+            if (!std::getline(stm, line)) return 0;
+            std::istringstream header(line);
+            std::string name;
+            unsigned column = 0, ncolumns = 0;
+            for (; header >> name; ncolumns++)
+                if (name == "CPU" + std::to_string(cpu)) column = ncolumns + 1;
+            if (!column) return 0;
+
+            uint64_t res = 0;
+            while (std::getline(stm, line)) {
+                std::istringstream row(line);
+                row >> name;
+                if (name == "LOC:") continue;
+                uint64_t count = 0;
+                for (auto i = 0u; i < column && row >> count; i++) ;
+                if (row) res += count;
+            }
+            return res;
+        }
+
+        inline std::string build_flags() {
+#ifdef MBM_BUILD_FLAGS
+            std::string res(MBM_BUILD_FLAGS);
+            res.erase(0, std::min(res.size(), res.find_first_not_of(' ')));
+            res.erase(res.find_last_not_of(' ') + 1);
+            return res;
+#else
+            std::string res;
+#ifdef __OPTIMIZE__
+            res = "optimized";
+#else
+            res = "unoptimized";
+#endif
+#ifdef NDEBUG
+            res += ", NDEBUG";
+#endif
+            return res;
+#endif
+        }
+    }
+
+    // Samples /proc/interrupts over irq_interval seconds, 0 skips the rate
+    inline environment capture_environment(unsigned cpu, double irq_interval = 0.1) {
+        environment res;
+        res.cpu = cpu_model();
+        if (max_cpuid_leaf() >= 0x16) {
+            uint32_t regs[4];
+            cpuid(0x16, regs);
+            res.base_mhz = regs[0] & 0xffff;
+        }
+        res.cpus = online_cpus();
+
+        const std::string sys = "/sys/devices/system/cpu/";
+        res.smt = detail::sysfs_flag(sys + "smt/active");
+        if (res.smt < 0 && !smt_siblings(cpu).empty()) res.smt = smt_siblings(cpu).size() > 1;
+        auto no_turbo = detail::sysfs_flag(sys + "intel_pstate/no_turbo");
+        res.turbo = no_turbo >= 0 ? !no_turbo : detail::sysfs_flag(sys + "cpufreq/boost");
+        res.governor = detail::sysfs_line(sys + "cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor");
+        std::ifstream isolated(sys + "isolated");
+        if (isolated) {
+            std::string line;
+            std::getline(isolated, line);
+            try {
+                auto cpus = parse_cpu_list(line);
+                res.isolated = std::find(std::begin(cpus), std::end(cpus), cpu) != std::end(cpus);
+            } catch (const std::invalid_argument &) { }
+        }
+
+        if (irq_interval > 0.0) {
+            auto before = detail::cpu_interrupts(cpu);
+            auto t0 = detail::monotonic_raw_ns();
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<uint64_t>(irq_interval * 1e6)));
+            auto after = detail::cpu_interrupts(cpu);
+            res.irq_rate = (after - before) * 1e9 / (detail::monotonic_raw_ns() - t0);
+        }
+
+        utsname un;
+        if (!uname(&un)) res.kernel = std::string(un.sysname) + " " + un.release;
+#if defined(__clang__)
+        res.compiler = __VERSION__;
+#elif defined(__GNUC__)
+        res.compiler = "g++ " __VERSION__;
+#endif
+        res.flags = detail::build_flags();
+        return res;
+    }
+
+    enum env_check { env_off, env_warn, env_refuse };
+
+    inline const char * name(env_check c) {
+        static const char * names[] = { "off", "warn", "refuse" };
+        return names[c];
+    }
+
+    inline bool parse(const std::string & str, env_check & res) {
+        if (str == "off") res = env_off;
+        else if (str == "warn") res = env_warn;
+        else if (str == "refuse") res = env_refuse;
+        else return false;
+        return true;
+    }
+}
+
+#endif // MBM_ENVIRONMENT_HPP_
@@ -0,0 +1,210 @@
+// =====================================================================================
+// 
+//       Filename:  histogram.hpp
+// 
+//    Description:  Log-linear (HDR) histogram
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 06:02:51 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_HISTOGRAM_HPP_
+#define MBM_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace mbm {
+    // Log-linear histogram of non-negative integers. Values below 2^k, the
+    // first power of two above 2 * 10^digits, get a bucket each; above that
+    // every power of two is split into 2^(k-1) buckets, so a bucket is never
+    // wider than 10^-digits of its values. Counts grow to the highest bucket
+    // recorded, so memory follows the values seen rather than the trackable
+    // range; record() is amortized O(1) and only allocates above what
+    // reserve() sized for. min, max and the moments are tracked exactly.
+    class histogram {
+    public:
+        histogram() : digits_(0), k_(0), highest_(0) { reset(); }
+
+        explicit histogram(unsigned digits, uint64_t highest = uint64_t(1) << 40) : digits_(digits), highest_(highest) {
+            if (digits < 1 || digits > 5) throw std::invalid_argument("histogram precision must be 1 to 5 digits");
+            auto sub_count = 2.0 * std::pow(10.0, digits);
+            for (k_ = 1; (uint64_t(1) << k_) < sub_count; k_++) ;
+            reset();
+        }
+
+        unsigned digits() const { return digits_; }
+        bool enabled() const { return digits_ != 0; }
+        uint64_t count() const { return n_; }
+        uint64_t min() const { return n_ ? min_ : 0; }
+        uint64_t max() const { return max_; }
+        double mean() const { return n_ ? sum_ / n_ : 0.0; }
+
+        // Population standard deviation, as stats::summarize
+        double stddev() const {
+            if (!n_) return 0.0;
+            auto m = mean();
+            return std::sqrt(std::max(0.0, sum_sq_ / n_ - m * m));
+        }
+
+        // Sizes the counts for values up to v
+        void reserve(uint64_t v) {
+            if (!enabled()) return;
+            auto n = index(std::min(v, highest_)) + 1;
+            if (n > counts_.size()) counts_.resize(n);
+        }
+
+        // Values above the highest trackable value are counted in the top bucket
+        void record(uint64_t v) {
+            auto i = index(std::min(v, highest_));
+            if (i >= counts_.size()) counts_.resize(i + 1);
+            counts_[i]++;
+            n_++;
+            min_ = std::min(min_, v);
+            max_ = std::max(max_, v);
+            auto d = static_cast<double>(v);
+            sum_ += d;
+            sum_sq_ += d * d;
+        }
+
+        void merge(const histogram & other) {
+            if (!other.enabled()) return;
+            if (!enabled()) {
+                *this = other;
+                return;
+            }
+            if (other.digits_ != digits_ || other.highest_ != highest_)
+                throw std::invalid_argument("merging histograms of different precision");
+            if (other.counts_.size() > counts_.size()) counts_.resize(other.counts_.size());
+            for (size_t i = 0; i < other.counts_.size(); i++) counts_[i] += other.counts_[i];
+            n_ += other.n_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+            sum_ += other.sum_;
+            sum_sq_ += other.sum_sq_;
+        }
+
+        void reset() {
+            counts_.clear();
+            n_ = 0;
+            min_ = std::numeric_limits<uint64_t>::max();
+            max_ = 0;
+            sum_ = sum_sq_ = 0.0;
+        }
+
+        // Value of the 0 based rank in sorted order: the middle of its bucket,
+        // kept within the exact min and max
+        double at_rank(uint64_t rank) const {
+            uint64_t seen = 0;
+            for (size_t i = 0; i < counts_.size(); i++) {
+                seen += counts_[i];
+                if (seen > rank) return value(i);
+            }
+            return static_cast<double>(max_);
+        }
+
+        // Linearly interpolated quantile, as stats::quantile
+        double quantile(double p) const {
+            if (!n_) return 0.0;
+            auto h = (n_ - 1) * std::min(1.0, std::max(0.0, p));
+            auto lo = static_cast<uint64_t>(std::floor(h));
+            auto vlo = at_rank(lo);
+            return lo + 1 < n_ ? vlo + (h - lo) * (at_rank(lo + 1) - vlo) : vlo;
+        }
+
+        // f(value, count) for every non-empty bucket in ascending order
+        template<typename F>
+        void for_each(F f) const {
+            for (size_t i = 0; i < counts_.size(); i++)
+                if (counts_[i]) f(value(i), counts_[i]);
+        }
+
+        // Raw state over a detail::fd_writer / fd_reader, the counts from
+        // the lowest to the highest non-empty bucket
+        template<typename Out>
+        void write(Out & out) const {
+            out.put(digits_);
+            if (!enabled()) return;
+            out.put(highest_);
+            auto first = std::find_if(std::begin(counts_), std::end(counts_), [](uint64_t c) { return c != 0; });
+            auto last = std::find_if(counts_.rbegin(), counts_.rend(), [](uint64_t c) { return c != 0; }).base();
+            if (first >= last) first = last = std::begin(counts_);
+            out.template put<uint64_t>(first - std::begin(counts_));
+            out.put(std::vector<uint64_t>(first, last));
+            out.put(n_);
+            out.put(min_);
+            out.put(max_);
+            out.put(sum_);
+            out.put(sum_sq_);
+        }
+
+        template<typename In>
+        void read(In & in) {
+            auto digits = in.template get<unsigned>();
+            if (!digits) {
+                *this = histogram();
+                return;
+            }
+            *this = histogram(digits, in.template get<uint64_t>());
+            auto first = in.template get<uint64_t>();
+            std::vector<uint64_t> counts;
+            in.get(counts);
+            if (first + counts.size() > index(highest_) + 1) throw std::runtime_error("histogram layout mismatch");
+            counts_.assign(first, 0);
+            counts_.insert(std::end(counts_), std::begin(counts), std::end(counts));
+            in.get(n_);
+            in.get(min_);
+            in.get(max_);
+            in.get(sum_);
+            in.get(sum_sq_);
+        }
+
+    private:
+        unsigned digits_;
+        unsigned k_;
+        uint64_t highest_;
+        std::vector<uint64_t> counts_;
+        uint64_t n_;
+        uint64_t min_;
+        uint64_t max_;
+        double sum_;
+        double sum_sq_;
+
+        size_t index(uint64_t v) const {
+            auto msb = 63u - static_cast<unsigned>(__builtin_clzll(v | ((uint64_t(1) << k_) - 1)));
+            auto bucket = msb - (k_ - 1);
+            return (static_cast<size_t>(bucket) << (k_ - 1)) + static_cast<size_t>(v >> bucket);
+        }
+
+        double value(size_t i) const {
+            size_t half = size_t(1) << (k_ - 1);
+            unsigned bucket = i < 2 * half ? 0 : static_cast<unsigned>(i / half - 1);
+            auto lowest = static_cast<double>(static_cast<uint64_t>(i - bucket * half) << bucket);
+            auto mid = lowest + ((uint64_t(1) << bucket) - 1) / 2.0;
+            return std::min(static_cast<double>(max_), std::max(static_cast<double>(min_), mid));
+        }
+    };
+}
+
+#endif // MBM_HISTOGRAM_HPP_
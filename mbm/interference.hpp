@@ -0,0 +1,171 @@
+// =====================================================================================
+// 
+//       Filename:  interference.hpp
+// 
+//    Description:  Per run interference from perf software counters
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 10:24:37 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_INTERFERENCE_HPP_
+#define MBM_INTERFERENCE_HPP_
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace mbm {
+    enum interference_id {
+        intf_context_switches,
+        intf_migrations,
+        intf_major_faults,
+        intf_count
+    };
+
+    inline const char * interference_name(interference_id id) {
+        static const char * names[intf_count] = { "ctx-switches", "migrations", "major-faults" };
+        return names[id];
+    }
+
+    enum interference_mode { interference_off, interference_mark, interference_rerun };
+
+    inline const char * name(interference_mode m) {
+        static const char * names[] = { "off", "mark", "rerun" };
+        return names[m];
+    }
+
+    inline bool parse(const std::string & str, interference_mode & res) {
+        if (str == "off") res = interference_off;
+        else if (str == "mark") res = interference_mark;
+        else if (str == "rerun") res = interference_rerun;
+        else return false;
+        return true;
+    }
+
+    // Runs of a fixture (or table row) that were descheduled, moved to
+    // another cpu or waited on a major fault while timed
+    struct interference_totals {
+        std::array<uint64_t, intf_count> events;
+        uint64_t runs;          // every timed run, including those rerun
+        uint64_t contaminated;
+        uint64_t reruns;        // contaminated runs discarded and run again
+        uint64_t excluded;      // contaminated runs left out of the statistics
+
+        interference_totals() : runs(0), contaminated(0), reruns(0), excluded(0) { events.fill(0); }
+
+        bool empty() const { return !runs; }
+        double rate() const { return runs ? static_cast<double>(contaminated) / runs : 0.0; }
+    };
+
+    // Software counters of the calling thread, read before and after each
+    // timed run. These events happen in the kernel, so they are counted
+    // with exclude_kernel clear, which needs perf_event_paranoid <= 1 or
+    // CAP_PERFMON; excluding the kernel would leave them at 0. There is no
+    // software event for interrupts; a run they stretch far enough to be
+    // preempted shows up as a context switch.
+    class interference_monitor {
+    public:
+        interference_monitor() : leader_(-1), clean_(true) {
+            fds_.fill(-1);
+            static const uint64_t configs[intf_count] = { 
+                PERF_COUNT_SW_CONTEXT_SWITCHES, PERF_COUNT_SW_CPU_MIGRATIONS, PERF_COUNT_SW_PAGE_FAULTS_MAJ 
+            };
+            for (auto i = 0; i < intf_count; i++) {
+                perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_SOFTWARE;
+                attr.config = configs[i];
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                auto fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0));
+                if (fd < 0) {
+                    auto err = errno;
+                    error_ = std::string("perf_event_open: ") + strerror(err);
+                    if (err == EACCES || err == EPERM) 
+                        error_ += " (needs perf_event_paranoid <= 1 or CAP_PERFMON)";
+                    close_all();
+                    return;
+                }
+                if (leader_ < 0) leader_ = fd;
+                fds_[i] = fd;
+            }
+        }
+
+        interference_monitor(const interference_monitor &) = delete;
+        interference_monitor & operator=(const interference_monitor &) = delete;
+
+        ~interference_monitor() { close_all(); }
+
+        bool ok() const { return leader_ >= 0; }
+        const std::string & error() const { return error_; }
+
+        void start() { read_events(before_); }
+
+        // False if any event happened since start()
+        bool stop(interference_totals & totals) {
+            std::array<uint64_t, intf_count> after;
+            read_events(after);
+            clean_ = true;
+            for (auto i = 0; i < intf_count; i++) {
+                auto delta = after[i] - before_[i];
+                totals.events[i] += delta;
+                if (delta) clean_ = false;
+            }
+            totals.runs++;
+            if (!clean_) totals.contaminated++;
+            return clean_;
+        }
+
+        // Whether the last stopped run was free of interference
+        bool clean() const { return clean_; }
+
+    private:
+        int leader_;
+        std::array<int, intf_count> fds_;
+        std::array<uint64_t, intf_count> before_;
+        bool clean_;
+        std::string error_;
+
+        void read_events(std::array<uint64_t, intf_count> & res) const {
+            // nr, value[nr]
+            std::array<uint64_t, 1 + intf_count> buf;
+            buf.fill(0);
+            if (read(leader_, buf.data(), sizeof(buf)) < 0) buf.fill(0);
+            std::copy(std::begin(buf) + 1, std::end(buf), std::begin(res));
+        }
+
+        void close_all() {
+            if (leader_ < 0) return;
+            for (auto fd : fds_) if (fd >= 0) close(fd);
+            leader_ = -1;
+        }
+    };
+}
+
+#endif // MBM_INTERFERENCE_HPP_
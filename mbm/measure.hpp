@@ -28,12 +28,20 @@
 #ifndef MBM_MEASURE_HPP_
 #define MBM_MEASURE_HPP_
 
-#include <boost/date_time/posix_time/posix_time.hpp>
-
 #include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <ctime>
 #include <type_traits>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <fstream>
 #include <ostream>
 #include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
 
 namespace mbm {
     inline uint64_t read_initial_tsc() {
@@ -72,29 +80,356 @@ namespace mbm {
         return res & (1 << 27);
     }
     
-    inline uint64_t clocks_per_microsecond() {
-        static uint64_t clocks;
-        if (clocks) return clocks;
-        auto now = boost::posix_time::microsec_clock::universal_time();
-        boost::posix_time::ptime next;
-        while ((next = boost::posix_time::microsec_clock::universal_time()) == now); // spin
-        auto tsc = read_initial_tsc();
-        next += boost::posix_time::microseconds(1000);
-        while (boost::posix_time::microsec_clock::universal_time() < next); // spin
-        auto ticks = read_final_tsc(std::false_type()) - tsc;
-        return clocks = ticks / 1000;
+    inline void cpuid(uint32_t leaf, uint32_t regs[4]) {
+        __asm__ __volatile__("cpuid" : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3]) 
+                : "a"(leaf), "c"(0));
+    }
+
+    inline uint32_t max_cpuid_leaf(uint32_t base = 0) {
+        uint32_t regs[4];
+        cpuid(base, regs);
+        return regs[0];
+    }
+
+    inline bool has_invariant_tsc() {
+        if (max_cpuid_leaf(0x80000000) < 0x80000007) return false;
+        uint32_t regs[4];
+        cpuid(0x80000007, regs);
+        return regs[3] & (1 << 8);
+    }
+
+    inline std::string cpu_model() {
+        std::string res;
+        if (max_cpuid_leaf(0x80000000) >= 0x80000004) {
+            for (uint32_t leaf = 0x80000002; leaf <= 0x80000004; leaf++) {
+                uint32_t regs[4];
+                cpuid(leaf, regs);
+                res.append(reinterpret_cast<const char*>(regs), sizeof(regs));
+            }
+            res = res.c_str();
+            res.erase(0, std::min(res.size(), res.find_first_not_of(' ')));
+        }
+        uint32_t regs[4];
+        cpuid(1, regs);
+        std::ostringstream stm;
+        stm << res << " [" << std::hex << regs[0] << "]";
+        return stm.str();
+    }
+
+    struct tsc_calibration {
+        enum source_t { none, cpuid_leaf, measured, cached };
+
+        double mhz;
+        double error;   // +/- MHz
+        source_t source;
+        bool invariant;
+
+        tsc_calibration() : mhz(0.0), error(0.0), source(none), invariant(false) { }
+
+        const char * source_name() const {
+            static const char * names[] = { "none", "cpuid", "measured", "cached" };
+            return names[source];
+        }
+
+        friend std::ostream & operator<<(std::ostream & stm, const tsc_calibration & that) {
+            std::ostringstream str;
+            str << std::fixed << std::setprecision(3) << that.mhz << "MHz +/- " << that.error << "MHz ("
+                << that.source_name() << (that.invariant ? ", invariant" : ", NOT invariant") << ")";
+            return stm << str.str();
+        }
+    };
+
+    namespace detail {
+        // Nominal TSC frequency from leaf 0x15 (TSC/crystal ratio), falling back
+        // to the base frequency in leaf 0x16 when the crystal clock is not enumerated
+        inline double cpuid_tsc_mhz() {
+            auto max_leaf = max_cpuid_leaf();
+            uint32_t regs[4];
+            if (max_leaf >= 0x15) {
+                cpuid(0x15, regs);
+                if (regs[0] && regs[1] && regs[2])
+                    return static_cast<double>(regs[2]) * regs[1] / regs[0] / 1e6;
+            }
+            if (max_leaf >= 0x16) {
+                cpuid(0x16, regs);
+                if (regs[0] & 0xffff)
+                    return regs[0] & 0xffff;
+            }
+            return 0.0;
+        }
+
+        inline uint64_t monotonic_raw_ns() {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+        }
+
+        // Pair a CLOCK_MONOTONIC_RAW reading with the TSC, keeping the
+        // narrowest of a few brackets to limit interrupt noise
+        inline void paired_read(uint64_t & tsc, uint64_t & ns) {
+            uint64_t best = ~0ull;
+            tsc = ns = 0;
+            for (auto i = 0; i < 5; i++) {
+                auto t0 = read_initial_tsc();
+                auto n = monotonic_raw_ns();
+                auto t1 = read_initial_tsc();
+                if (t1 - t0 < best) {
+                    best = t1 - t0;
+                    tsc = t0 + (t1 - t0) / 2;
+                    ns = n;
+                }
+            }
+        }
+
+        inline tsc_calibration measure_tsc(unsigned samples = 7, uint64_t interval_ns = 2000000) {
+            std::vector<double> mhz;
+            for (auto i = 0u; i < samples; i++) {
+                uint64_t tsc0, ns0, tsc1, ns1;
+                paired_read(tsc0, ns0);
+                while (monotonic_raw_ns() - ns0 < interval_ns); // spin
+                paired_read(tsc1, ns1);
+                mhz.push_back(static_cast<double>(tsc1 - tsc0) * 1e3 / (ns1 - ns0));
+            }
+            std::sort(std::begin(mhz), std::end(mhz));
+
+            tsc_calibration res;
+            res.mhz = mhz[mhz.size() / 2];
+            res.error = (mhz.back() - mhz.front()) / 2;
+            res.source = tsc_calibration::measured;
+            return res;
+        }
+
+        inline std::string boot_id() {
+            std::ifstream stm("/proc/sys/kernel/random/boot_id");
+            std::string res;
+            std::getline(stm, res);
+            return res;
+        }
+
+        inline std::string tsc_cache_path() {
+            if (auto path = getenv("MBM_TSC_CACHE")) return path;
+            std::string dir;
+            if (auto xdg = getenv("XDG_CACHE_HOME")) 
+                dir = xdg;
+            else if (auto home = getenv("HOME"))
+                dir = std::string(home) + "/.cache";
+            else
+                return std::string();
+            mkdir(dir.c_str(), 0755);
+            return dir + "/mbm_tsc_calibration";
+        }
+
+        // Cache layout is three lines: boot id, cpu model, "mhz error"
+        inline bool load_tsc_cache(const std::string & path, const std::string & key, tsc_calibration & res) {
+            std::ifstream stm(path);
+            std::string boot, model;
+            if (!std::getline(stm, boot) || !std::getline(stm, model)) return false;
+            if (boot + '\n' + model != key) return false;
+            if (!(stm >> res.mhz >> res.error) || res.mhz <= 0.0) return false;
+            res.source = tsc_calibration::cached;
+            return true;
+        }
+
+        inline void save_tsc_cache(const std::string & path, const std::string & key, const tsc_calibration & cal) {
+            auto tmp = path + ".tmp";
+            {
+                std::ofstream stm(tmp);
+                if (!stm) return;
+                stm << key << '\n' << std::setprecision(12) << cal.mhz << ' ' << cal.error << '\n';
+                if (!stm) return;
+            }
+            std::rename(tmp.c_str(), path.c_str());
+        }
+
+        inline tsc_calibration calibrate_tsc() {
+            tsc_calibration res;
+            auto invariant = has_invariant_tsc();
+            auto nominal = invariant ? cpuid_tsc_mhz() : 0.0;
+            if (nominal > 0.0) {
+                res.mhz = nominal;
+                res.source = tsc_calibration::cpuid_leaf;
+            } else {
+                auto boot = boot_id();
+                auto path = boot.empty() ? std::string() : tsc_cache_path();
+                auto key = boot + '\n' + cpu_model();
+                if (path.empty() || !load_tsc_cache(path, key, res)) {
+                    res = measure_tsc();
+                    if (!path.empty()) save_tsc_cache(path, key, res);
+                }
+            }
+            res.invariant = invariant;
+            return res;
+        }
+    }
+
+    inline const tsc_calibration & tsc_frequency() {
+        static const tsc_calibration cal = detail::calibrate_tsc();
+        return cal;
+    }
+
+    inline double clocks_per_microsecond() {
+        return tsc_frequency().mhz;
+    }
+
+    // Timer policies for the measurement loop. start() and stop() return
+    // TSC cycles (clock converts nanoseconds) so the rest of the framework
+    // works in a single unit.
+    namespace timer {
+        // cpuid;rdtsc ... cpuid;rdtsc;cpuid - serializing, but each cpuid
+        // is a VM exit under most hypervisors
+        struct cpuid {
+            static const char * name() { return "cpuid"; }
+            static uint64_t start() { return read_initial_tsc(); }
+            static uint64_t stop() { return read_final_tsc(std::true_type()); }
+        };
+
+        // cpuid;rdtsc ... rdtscp;cpuid
+        struct cpuid_rdtscp {
+            static const char * name() { return "cpuid-rdtscp"; }
+            static uint64_t start() { return read_initial_tsc(); }
+            static uint64_t stop() { return read_final_tsc(std::false_type()); }
+        };
+
+        inline uint64_t lfence_rdtsc_lfence() {
+            uint32_t lo, hi;
+            __asm__ __volatile__("lfence\n\trdtsc\n\tlfence" : "=a"(lo), "=d"(hi) :: "memory");
+            return (static_cast<uint64_t>(hi) << 32) | lo;
+        }
+
+        // lfence;rdtsc;lfence on both sides, no VM exits
+        struct lfence {
+            static const char * name() { return "lfence"; }
+            static uint64_t start() { return lfence_rdtsc_lfence(); }
+            static uint64_t stop() { return lfence_rdtsc_lfence(); }
+        };
+
+        // lfence;rdtsc;lfence ... rdtscp;lfence
+        struct rdtscp {
+            static const char * name() { return "rdtscp"; }
+            static uint64_t start() { return lfence_rdtsc_lfence(); }
+            static uint64_t stop() {
+                uint32_t lo, hi;
+                __asm__ __volatile__("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi) :: "%rcx", "memory");
+                return (static_cast<uint64_t>(hi) << 32) | lo;
+            }
+        };
+
+        // clock_gettime(CLOCK_MONOTONIC_RAW) through the vDSO
+        struct clock {
+            static const char * name() { return "clock"; }
+            static uint64_t start() { return read(); }
+            static uint64_t stop() { return read(); }
+
+            static uint64_t read() {
+                static const double clocks_per_ns = tsc_frequency().mhz / 1000.0;
+                return static_cast<uint64_t>(detail::monotonic_raw_ns() * clocks_per_ns);
+            }
+        };
+
+        enum kind { cpuid_kind, cpuid_rdtscp_kind, lfence_kind, rdtscp_kind, clock_kind, kind_count };
+
+        inline const char * name(kind k) {
+            static const char * names[kind_count] = {
+                cpuid::name(), cpuid_rdtscp::name(), lfence::name(), rdtscp::name(), clock::name()
+            };
+            return names[k];
+        }
+
+        inline bool available(kind k) {
+            return (k != cpuid_rdtscp_kind && k != rdtscp_kind) || has_rdtscp();
+        }
+
+        inline kind default_kind() { return has_rdtscp() ? cpuid_rdtscp_kind : cpuid_kind; }
+
+        // Returns false if the name is unknown or the backend is unsupported
+        inline bool parse(const std::string & str, kind & res) {
+            for (auto i = 0; i < kind_count; i++) {
+                auto k = static_cast<kind>(i);
+                if (str == name(k)) {
+                    res = k;
+                    return available(k);
+                }
+            }
+            return false;
+        }
+
+        // Cost of back to back start()/stop() pairs
+        struct calibration {
+            uint64_t min;
+            uint64_t median;
+            uint64_t p99;
+
+            double jitter() const { return static_cast<double>(p99 - min); }
+        };
+
+        template<typename Timer>
+        calibration calibrate(unsigned samples = 10000) {
+            std::vector<uint64_t> res(samples);
+            for (auto & r : res) {
+                auto t0 = Timer::start();
+                auto t1 = Timer::stop();
+                r = t1 - t0;
+            }
+            std::sort(std::begin(res), std::end(res));
+            return calibration { res.front(), res[samples / 2], res[samples * 99 / 100] };
+        }
+
+        inline calibration calibrate(kind k) {
+            switch (k) {
+                case cpuid_kind: return calibrate<cpuid>();
+                case cpuid_rdtscp_kind: return calibrate<cpuid_rdtscp>();
+                case lfence_kind: return calibrate<lfence>();
+                case rdtscp_kind: return calibrate<rdtscp>();
+                default: return calibrate<clock>();
+            }
+        }
+
+        template<typename Timer> struct kind_of;
+        template<> struct kind_of<cpuid> : std::integral_constant<kind, cpuid_kind> { };
+        template<> struct kind_of<cpuid_rdtscp> : std::integral_constant<kind, cpuid_rdtscp_kind> { };
+        template<> struct kind_of<lfence> : std::integral_constant<kind, lfence_kind> { };
+        template<> struct kind_of<rdtscp> : std::integral_constant<kind, rdtscp_kind> { };
+        template<> struct kind_of<clock> : std::integral_constant<kind, clock_kind> { };
+
+        // Cycles of batch calls of f(), instantiated with f inlined into the loop
+        template<typename Timer, typename F>
+        uint64_t time_loop(unsigned batch, F & f) {
+            auto t0 = Timer::start();
+            for (auto i = 0u; i < batch; i++)
+                f();
+            auto t1 = Timer::stop();
+            return t1 - t0;
+        }
+
+        template<typename F>
+        uint64_t time_loop(kind k, unsigned batch, F f) {
+            switch (k) {
+                case cpuid_kind: return time_loop<cpuid>(batch, f);
+                case cpuid_rdtscp_kind: return time_loop<cpuid_rdtscp>(batch, f);
+                case lfence_kind: return time_loop<lfence>(batch, f);
+                case rdtscp_kind: return time_loop<rdtscp>(batch, f);
+                default: return time_loop<clock>(batch, f);
+            }
+        }
     }
 
     struct as_cycles {
-        uint64_t cycles;
+        double cycles;
 
-        as_cycles(uint64_t cycles) : cycles(cycles) { }
+        as_cycles(double cycles) : cycles(cycles) { }
 
         friend std::ostream & operator<<(std::ostream & stm, const as_cycles & that) {
             std::ostringstream str;    
-            str << std::fixed << std::setprecision(1) << 
-                static_cast<double>(that.cycles) / clocks_per_microsecond() << "us (" <<
-                    that.cycles << "clk)";
+            auto us = that.cycles / clocks_per_microsecond();
+            str << std::fixed << std::setprecision(1);
+            if (us < 1.0)
+                str << us * 1000.0 << "ns (";
+            else
+                str << us << "us (";
+            if (that.cycles < 1000.0)
+                str << that.cycles << "clk)";
+            else
+                str << std::setprecision(0) << that.cycles << "clk)";
             return stm << str.str();
         }        
     };
@@ -0,0 +1,294 @@
+// =====================================================================================
+// 
+//       Filename:  params.hpp
+// 
+//    Description:  Lazy parameter generators for table fixtures
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 10:51:09 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_PARAMS_HPP_
+#define MBM_PARAMS_HPP_
+
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mbm {
+    // A generator is a lazily evaluated sequence of table parameters: size(),
+    // operator[](i), the labels of its dimensions, whether each is numeric
+    // and the strings of each dimension of a value. A range holds its bounds, never its values.
+    namespace detail {
+        template<typename T>
+        double arithmetic_number(const T & v, std::true_type) { return static_cast<double>(v); }
+
+        template<typename T>
+        double arithmetic_number(const T &, std::false_type) { return 0.0; }
+
+        // To the decimal digits T holds exactly, so 0.1 is not labeled
+        // 0.10000000000000001, nor 3 * 0.1 as 0.30000000000000004
+        template<typename T>
+        std::string to_string(const T & v, std::true_type) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.*g", std::numeric_limits<T>::digits10, static_cast<double>(v));
+            return buf;
+        }
+
+        template<typename T>
+        std::string to_string(const T & v, std::false_type) { return boost::lexical_cast<std::string>(v); }
+
+        // Arithmetic types other than characters, which print as text
+        template<typename T, typename U = typename std::remove_cv<T>::type>
+        struct is_number : std::integral_constant<bool, std::is_arithmetic<U>::value && 
+            !std::is_same<U, char>::value && !std::is_same<U, signed char>::value && 
+            !std::is_same<U, unsigned char>::value && !std::is_same<U, wchar_t>::value && 
+            !std::is_same<U, char16_t>::value && !std::is_same<U, char32_t>::value> { };
+    }
+
+    // One labeled dimension of a table row, its value as a string and
+    // whether the dimension's type makes that string a number
+    struct param_value {
+        std::string label;
+        std::string value;
+        bool number;
+    };
+
+    // One dimension with values of type T
+    template<typename T>
+    struct dimension {
+        typedef T value_type;
+        typedef void generator_tag;
+
+        std::string label;
+
+        std::vector<std::string> labels() const { return std::vector<std::string>(1, label); }
+        std::vector<bool> numeric() const { return std::vector<bool>(1, detail::is_number<T>::value); }
+
+        void strings(const T & v, std::vector<std::string> & res) const { 
+            res.push_back(detail::to_string(v, std::is_floating_point<T>())); 
+        }
+
+        // Scales per element statistics, 0 if T is not arithmetic
+        double number(const T & v) const { return detail::arithmetic_number(v, std::is_arithmetic<T>()); }
+    };
+
+    // first, first + step, ... up to and including last
+    template<typename T>
+    class linear_range : public dimension<T> {
+    public:
+        linear_range(T first, T last, T step) : first_(first), last_(last), step_(step) {
+            if (!(step > T())) throw std::invalid_argument("range step must be positive");
+        }
+
+        size_t size() const { return last_ < first_ ? 0 : steps(std::is_floating_point<T>()) + 1; }
+        T operator[](size_t i) const { return std::min(last_, static_cast<T>(first_ + static_cast<T>(i) * step_)); }
+
+    private:
+        T first_, last_, step_;
+
+        size_t steps(std::false_type) const { return static_cast<size_t>((last_ - first_) / step_); }
+
+        // Allowing for rounding, as geometric_range, so range(0.0, 0.3, 0.1) ends at 0.3
+        size_t steps(std::true_type) const { 
+            return static_cast<size_t>(static_cast<double>((last_ - first_) / step_) * (1.0 + 1e-12) + 1e-9); 
+        }
+    };
+
+    // first, first * factor, ... up to and including last, rounded for integral T
+    template<typename T>
+    class geometric_range : public dimension<T> {
+    public:
+        geometric_range(T first, T last, double factor) : first_(first), factor_(factor), size_(0) {
+            if (!(first > T()) || !(factor > 1.0)) throw std::invalid_argument("geometric range needs first > 0 and factor > 1");
+            while (value(size_) <= static_cast<double>(last) * (1.0 + 1e-12)) size_++;
+        }
+
+        size_t size() const { return size_; }
+        T operator[](size_t i) const { return round(value(i), std::is_integral<T>()); }
+
+    private:
+        T first_;
+        double factor_;
+        size_t size_;
+
+        double value(size_t i) const { return static_cast<double>(first_) * std::pow(factor_, static_cast<double>(i)); }
+        static T round(double v, std::true_type) { return static_cast<T>(std::llround(v)); }
+        static T round(double v, std::false_type) { return static_cast<T>(v); }
+    };
+
+    // The powers of two from first up to and including last
+    template<typename T>
+    class pow2_range : public dimension<T> {
+        static_assert(std::is_integral<T>::value, "pow2 ranges are integral");
+    public:
+        pow2_range(T first, T last) : shift_(0), size_(0) {
+            if (first < 1) first = 1;
+            while ((T(1) << shift_) < first) shift_++;
+            for (auto s = shift_; s < sizeof(T) * 8 - 1 && (T(1) << s) <= last; s++) size_++;
+        }
+
+        size_t size() const { return size_; }
+        T operator[](size_t i) const { return T(1) << (shift_ + i); }
+
+    private:
+        unsigned shift_;
+        size_t size_;
+    };
+
+    template<typename T>
+    class value_list : public dimension<T> {
+    public:
+        explicit value_list(std::vector<T> values) : values_(std::move(values)) { }
+
+        size_t size() const { return values_.size(); }
+        T operator[](size_t i) const { return values_[i]; }
+
+    private:
+        std::vector<T> values_;
+    };
+
+    namespace detail {
+        template<size_t... I> struct indices { };
+
+        template<size_t N, size_t... I>
+        struct make_indices : make_indices<N - 1, N - 1, I...> { };
+
+        template<size_t... I>
+        struct make_indices<0, I...> { typedef indices<I...> type; };
+
+        inline void expand(std::initializer_list<int>) { }
+    }
+
+    // Every combination of the values of its dimensions, the last one
+    // varying fastest; elements are taken from the first dimension
+    template<typename... G>
+    class cartesian_product {
+    public:
+        typedef std::tuple<typename G::value_type...> value_type;
+        typedef void generator_tag;
+
+        explicit cartesian_product(G... dims) : dims_(std::move(dims)...) { }
+
+        size_t size() const { return size(indices()); }
+
+        value_type operator[](size_t i) const { return at(i, indices()); }
+
+        std::vector<std::string> labels() const {
+            std::vector<std::string> res;
+            labels(res, indices());
+            return res;
+        }
+
+        std::vector<bool> numeric() const {
+            std::vector<bool> res;
+            numeric(res, indices());
+            return res;
+        }
+
+        void strings(const value_type & v, std::vector<std::string> & res) const { strings(v, res, indices()); }
+
+        double number(const value_type & v) const { return std::get<0>(dims_).number(std::get<0>(v)); }
+
+    private:
+        typedef typename detail::make_indices<sizeof...(G)>::type indices;
+        std::tuple<G...> dims_;
+
+        template<size_t... I>
+        size_t size(detail::indices<I...>) const {
+            size_t res = 1;
+            detail::expand({ (res *= std::get<I>(dims_).size(), 0)... });
+            return res;
+        }
+
+        // Mixed radix digits of i, most significant first
+        template<size_t... I>
+        value_type at(size_t i, detail::indices<I...>) const {
+            size_t digits[] = { std::get<I>(dims_).size()... };
+            for (auto d = sizeof...(G); d-- > 0; ) {
+                auto n = digits[d];
+                digits[d] = i % n;
+                i /= n;
+            }
+            return value_type(std::get<I>(dims_)[digits[I]]...);
+        }
+
+        template<size_t... I>
+        void labels(std::vector<std::string> & res, detail::indices<I...>) const {
+            detail::expand({ (append(res, std::get<I>(dims_).labels()), 0)... });
+        }
+
+        template<size_t... I>
+        void numeric(std::vector<bool> & res, detail::indices<I...>) const {
+            detail::expand({ (append(res, std::get<I>(dims_).numeric()), 0)... });
+        }
+
+        template<size_t... I>
+        void strings(const value_type & v, std::vector<std::string> & res, detail::indices<I...>) const {
+            detail::expand({ (std::get<I>(dims_).strings(std::get<I>(v), res), 0)... });
+        }
+
+        template<typename T>
+        static void append(std::vector<T> & res, const std::vector<T> & more) {
+            res.insert(std::end(res), std::begin(more), std::end(more));
+        }
+    };
+
+    template<typename G, typename = void>
+    struct is_generator : std::false_type { };
+
+    template<typename G>
+    struct is_generator<G, typename G::generator_tag> : std::true_type { };
+
+    template<typename T>
+    linear_range<T> range(T first, T last, T step = T(1)) { return linear_range<T>(first, last, step); }
+
+    template<typename T>
+    geometric_range<T> geometric(T first, T last, double factor) { return geometric_range<T>(first, last, factor); }
+
+    template<typename T>
+    pow2_range<T> pow2(T first, T last) { return pow2_range<T>(first, last); }
+
+    template<typename T>
+    value_list<T> values(std::initializer_list<T> list) { return value_list<T>(std::vector<T>(list)); }
+
+    template<typename... G>
+    cartesian_product<G...> cartesian(G... dims) { return cartesian_product<G...>(std::move(dims)...); }
+
+    // Names the dimension in labels and machine readable reports
+    template<typename G>
+    G labeled(const std::string & label, G dim) {
+        dim.label = label;
+        return dim;
+    }
+}
+
+#endif // MBM_PARAMS_HPP_
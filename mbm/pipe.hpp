@@ -0,0 +1,139 @@
+// =====================================================================================
+// 
+//       Filename:  pipe.hpp
+// 
+//    Description:  Buffered binary reads and writes over file descriptors
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 08:31:16 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_PIPE_HPP_
+#define MBM_PIPE_HPP_
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace mbm {
+namespace detail {
+    // Values are written in host byte order and layout, both ends are the
+    // same binary
+    class fd_writer {
+    public:
+        explicit fd_writer(int fd) : fd_(fd) { buf_.reserve(capacity); }
+
+        template<typename T>
+        void put(const T & v) { write(&v, sizeof(v)); }
+
+        template<typename T>
+        void put(const std::vector<T> & v) {
+            put<uint64_t>(v.size());
+            write(v.data(), v.size() * sizeof(T));
+        }
+
+        void put(const std::string & s) {
+            put<uint64_t>(s.size());
+            write(s.data(), s.size());
+        }
+
+        void write(const void * data, size_t n) {
+            auto p = static_cast<const char*>(data);
+            if (buf_.size() + n <= capacity) {
+                buf_.insert(std::end(buf_), p, p + n);
+                return;
+            }
+            flush();
+            write_fd(p, n);
+        }
+
+        void flush() {
+            write_fd(buf_.data(), buf_.size());
+            buf_.clear();
+        }
+
+    private:
+        static const size_t capacity = 1 << 16;
+        int fd_;
+        std::vector<char> buf_;
+
+        void write_fd(const char * p, size_t n) {
+            while (n) {
+                auto res = ::write(fd_, p, n);
+                if (res < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string("pipe write: ") + strerror(errno));
+                }
+                p += res;
+                n -= res;
+            }
+        }
+    };
+
+    class fd_reader {
+    public:
+        explicit fd_reader(int fd) : fd_(fd) { }
+
+        template<typename T>
+        T get() {
+            T v;
+            read(&v, sizeof(v));
+            return v;
+        }
+
+        template<typename T>
+        void get(T & v) { read(&v, sizeof(v)); }
+
+        template<typename T>
+        void get(std::vector<T> & v) {
+            v.resize(get<uint64_t>());
+            read(v.data(), v.size() * sizeof(T));
+        }
+
+        void get(std::string & s) {
+            s.resize(get<uint64_t>());
+            read(&s[0], s.size());
+        }
+
+        void read(void * data, size_t n) {
+            auto p = static_cast<char*>(data);
+            while (n) {
+                auto res = ::read(fd_, p, n);
+                if (res < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string("pipe read: ") + strerror(errno));
+                }
+                if (!res) throw std::runtime_error("pipe closed mid message");
+                p += res;
+                n -= res;
+            }
+        }
+
+    private:
+        int fd_;
+    };
+}
+}
+
+#endif // MBM_PIPE_HPP_
@@ -0,0 +1,891 @@
+// =====================================================================================
+// 
+//       Filename:  reporter.hpp
+// 
+//    Description:  Console, JSON and CSV result reporters
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 05:03:27 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_REPORTER_HPP_
+#define MBM_REPORTER_HPP_
+
+#include "counters.hpp"
+#include "allocs.hpp"
+#include "environment.hpp"
+#include "interference.hpp"
+#include "measure.hpp"
+#include "params.hpp"
+#include "stats.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mbm {
+    // How the results were obtained
+    struct run_context {
+        std::string timer;
+        tsc_calibration tsc;
+        std::string cpu;
+        int pincore;
+        unsigned numruns;
+        uint64_t overhead;          // cycles subtracted from every run
+        uint64_t inline_overhead;   // from every run of an inline_fixture
+        uint64_t batch_cycles;
+        bool counters;
+        bool allocs;
+        bool alloc_hooks;           // allocation counts available, page faults always are
+        bool interference;
+        bool warmup;
+        double precision;           // adaptive sampling target, 0 for a fixed run count
+        stats::estimator estimator;
+        stats::config stats;
+        std::string compare_file;   // saved baseline the run is checked against, if any
+        std::string cache;          // warm, cold or both
+        environment env;
+
+        run_context() : pincore(0), numruns(0), overhead(0), inline_overhead(0), batch_cycles(0), counters(false), allocs(false), 
+            alloc_hooks(false), interference(false), warmup(false), 
+            precision(0.0), estimator(stats::median) { }
+    };
+
+    namespace detail {
+        inline std::string label(const std::string & name, const std::string & param, bool table, unsigned threads,
+                                 bool cold) {
+            auto res = table ? name + "(" + param + ")" : name;
+            if (threads) res += " [" + std::to_string(threads) + (threads > 1 ? " threads]" : " thread]");
+            return cold ? res + " [cold]" : res;
+        }
+
+        // A CSV field, quotes doubled
+        inline std::string csv_quote(const std::string & str) {
+            std::string res("\"");
+            for (auto c : str) {
+                if (c == '"') res += '"';
+                res += c;
+            }
+            return res + '"';
+        }
+    }
+
+    // One fixture, or one row of a table fixture. Samples are per call
+    // cycles net of the timing overhead.
+    struct fixture_result {
+        std::string group;
+        std::string name;
+        std::string param;
+        bool table;
+        double elements;
+        std::vector<param_value> params;  // labeled dimensions of param
+        std::vector<double> samples;     // a uniform subset of the runs when hist is set
+        stats::summary summary;
+        const histogram * hist;          // every run in cycles net of overhead, or nullptr
+        size_t warmup;              // runs discarded
+        bool steady;
+        unsigned batch;
+        const char * stop;          // why sampling stopped, nullptr for a fixed run count
+        double precision;
+        counter_totals counters;
+        alloc_totals allocs;
+        interference_totals interference;
+        unsigned threads;                // 0 unless run on a thread team
+        double throughput;               // calls per second over all threads, threaded runs only
+        bool cold;                       // caches evicted before each run
+        double items;                    // work per call declared by the fixture, 0 if none
+        double bytes;
+
+        std::string label() const { return detail::label(name, param, table, threads, cold); }
+    };
+
+    struct comparison_result {
+        std::string group;
+        std::string baseline;
+        std::string name;
+        std::string param;
+        bool table;
+        unsigned threads;
+        bool cold;
+        bool per_item;              // compared per declared item rather than per call
+        stats::comparison cmp;
+
+        std::string label() const { return detail::label(name, param, table, threads, cold); }
+    };
+
+    // Throughput of a threaded fixture (or table row) across a --threads sweep
+    struct scaling_result {
+        struct point {
+            unsigned threads;
+            double throughput;          // calls per second
+            double speedup;             // over the smallest thread count
+            double efficiency;          // speedup per added thread, 1 is linear
+            double latency;             // median cycles per call on each thread
+        };
+
+        std::string group;
+        std::string name;
+        std::string param;
+        bool table;
+        bool cold;
+        std::vector<point> points;
+
+        std::string label() const { return detail::label(name, param, table, 0, cold); }
+    };
+
+    // Best fitting complexity of a table fixture's per call times (ns) over
+    // the elements of its rows, for each value of its other dimensions
+    struct complexity_result {
+        std::string group;
+        std::string name;
+        std::string param;              // the other dimensions of a cartesian table
+        unsigned threads;
+        bool cold;
+        stats::complexity_fit fit;
+        bool saved;                     // also fitted to the same rows of the --compare baseline
+        stats::complexity_fit baseline;
+        bool regression;                // a higher order than the baseline, decisively on both
+
+        std::string label() const { return detail::label(name, param, !param.empty(), threads, cold); }
+    };
+
+    struct regression_result {
+        std::string group;
+        std::string name;
+        std::string param;
+        bool table;
+        unsigned threads;
+        bool cold;
+        bool saved;                 // false for fixtures added since the baseline
+        bool current;               // false for baseline entries nothing ran for
+        bool per_item;              // times per declared item, both runs declared items
+        double baseline_ns, current_ns;
+        double change;              // relative, > 0 is slower
+        double tolerance;
+        const char * status;
+        bool regression;
+
+        std::string label() const { 
+            auto res = detail::label(name, param, table, threads, cold);
+            return group.empty() ? res : group + ": " + res;
+        }
+    };
+
+    // Receives results as they are produced, so implementations write
+    // straight to their stream rather than buffering a run
+    class reporter {
+    public:
+        explicit reporter(std::ostream & stm) : stm_(stm) { }
+        virtual ~reporter() { }
+
+        virtual void begin(const run_context & ctx) { ctx_ = ctx; }
+        virtual void begin_group(const std::string & group) { }
+        virtual void result(const fixture_result & res) = 0;
+        virtual void comparison(const comparison_result & res) { }
+        virtual void scaling(const scaling_result & res) { }
+        virtual void complexity(const complexity_result & res) { }
+        virtual void end_group(const std::string & group) { }
+        virtual void regression(const regression_result & res) { }
+        virtual void end() { stm_.flush(); }
+
+    protected:
+        std::ostream & stm_;
+        run_context ctx_;
+
+        double ns(double cycles) const { return cycles * 1000.0 / ctx_.tsc.mhz; }
+
+        // Median time per declared item, items per second over all threads
+        // and bytes per ns (GB/s)
+        double ns_per_item(const fixture_result & res) const { return ns(res.summary.median) / res.items; }
+
+        double items_per_second(const fixture_result & res) const { 
+            return res.threads ? res.throughput * res.items : res.items * 1e9 / ns(res.summary.median); 
+        }
+
+        double gb_per_second(const fixture_result & res) const { 
+            return res.threads ? res.throughput * res.bytes / 1e9 : res.bytes / ns(res.summary.median); 
+        }
+    };
+
+    class console_reporter : public reporter {
+    public:
+        console_reporter(std::ostream & stm, bool verbose) : reporter(stm), verbose_(verbose), header_(false), complexity_header_(false), regressions_(0) { }
+
+        virtual void begin(const run_context & ctx) {
+            reporter::begin(ctx);
+            const auto & env = ctx.env;
+            stm_ << "Machine: " << env.cpu << ", " << env.cpus << " cpus";
+            if (env.base_mhz) stm_ << ", " << env.base_mhz << "MHz base";
+            if (env.smt >= 0) stm_ << ", smt " << (env.smt ? "on" : "off");
+            if (env.turbo >= 0) stm_ << ", turbo " << (env.turbo ? "on" : "off");
+            if (!env.governor.empty()) stm_ << ", governor " << env.governor;
+            if (env.isolated >= 0) stm_ << ", core " << ctx.pincore << (env.isolated ? " isolated" : " not isolated");
+            if (env.irq_rate >= 0.0) stm_ << ", " << static_cast<uint64_t>(env.irq_rate) << " irq/s";
+            stm_ << std::endl << "Build: " << env.kernel << ", " << env.compiler << ", " << env.flags << std::endl;
+        }
+
+        virtual void begin_group(const std::string & group) {
+            stm_ << std::string(10, '=') << ' ' << (group.empty() ? "Ungrouped" : group) << ' ' 
+                << std::string(10, '=') << std::endl;
+            baseline_.clear();
+            complexity_header_ = false;
+        }
+
+        virtual void result(const fixture_result & res) {
+            stm_ << res.label();
+            if (verbose_) 
+                verbose_summary(res);
+            else
+                brief_summary(res);
+            work(res);
+            counters(res);
+            allocs(res);
+            interference(res);
+            stm_ << std::endl;
+        }
+
+        virtual void comparison(const comparison_result & res) {
+            if (res.baseline != baseline_) {
+                stm_ << std::string(10, '-') << " vs " << res.baseline << ' ' << std::string(10, '-') << std::endl;
+                baseline_ = res.baseline;
+            }
+            std::ostringstream str;
+            str << std::fixed << std::setprecision(2) << res.label() << ": " << res.cmp.ratio << "x [" 
+                << res.cmp.ci_low << ", " << res.cmp.ci_high << "] "
+                << (res.cmp.direction() > 0 ? "faster" : res.cmp.direction() < 0 ? "slower" : "within noise")
+                << std::setprecision(4) << ", p=" << res.cmp.p_value << (res.per_item ? " (per item)" : "");
+            stm_ << str.str() << std::endl;
+        }
+
+        virtual void scaling(const scaling_result & res) {
+            stm_ << std::string(10, '-') << " scaling: " << res.label() << ' ' << std::string(10, '-') << std::endl
+                << std::setw(8) << "threads" << std::setw(14) << "throughput" << std::setw(10) << "speedup" 
+                << std::setw(12) << "efficiency" << "  latency" << std::endl;
+            for (const auto & p : res.points) {
+                std::ostringstream line;
+                line << std::fixed << std::setprecision(2) << std::setw(8) << p.threads << std::setw(14) << rate(p.throughput) 
+                    << std::setw(9) << p.speedup << 'x' << std::setprecision(1) << std::setw(11) << p.efficiency * 100.0 
+                    << "%  " << as_cycles(p.latency);
+                stm_ << line.str() << std::endl;
+            }
+        }
+
+        virtual void complexity(const complexity_result & res) {
+            if (!complexity_header_) {
+                stm_ << std::string(10, '-') << " complexity " << std::string(10, '-') << std::endl;
+                complexity_header_ = true;
+            }
+            std::ostringstream line;
+            line << res.label() << ": " << stats::name(res.fit.model) << ", " << fit(res.fit) 
+                << ", rms " << percent(res.fit.rms);
+            if (res.saved && res.baseline.model != res.fit.model)
+                line << ", was " << stats::name(res.baseline.model) << (res.regression ? " REGRESSION" : " (within noise)");
+            stm_ << line.str() << std::endl;
+            if (res.regression) regressions_++;
+        }
+
+        virtual void regression(const regression_result & res) {
+            if (!header_) {
+                stm_ << std::string(10, '=') << " vs " << ctx_.compare_file << ' ' << std::string(10, '=') << std::endl
+                    << std::left << std::setw(40) << "fixture" << std::right << std::setw(12) << "baseline" 
+                    << std::setw(12) << "current" << std::setw(10) << "change" << std::setw(10) << "tolerance" 
+                    << "  status" << std::endl;
+                header_ = true;
+            }
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(1) << std::left << std::setw(40) << res.label() << std::right;
+            if (!res.current)
+                line << std::setw(10) << res.baseline_ns << "ns" << std::setw(12) << "-" 
+                    << std::setw(10) << "-" << std::setw(10) << "-";
+            else if (res.saved)
+                line << std::setw(10) << res.baseline_ns << "ns" << std::setw(10) << res.current_ns << "ns" 
+                    << std::showpos << std::setw(9) << res.change * 100.0 << '%' << std::noshowpos
+                    << std::setw(9) << res.tolerance * 100.0 << '%';
+            else
+                line << std::setw(12) << "-" << std::setw(10) << res.current_ns << "ns" 
+                    << std::setw(10) << "-" << std::setw(10) << "-";
+            stm_ << line.str() << "  " << res.status << (res.per_item ? " (per item)" : "") << std::endl;
+            if (res.regression) regressions_++;
+        }
+
+        virtual void end() {
+            if (!ctx_.compare_file.empty()) stm_ << regressions_ << " regression(s)" << std::endl;
+            reporter::end();
+        }
+
+    private:
+        bool verbose_;
+        bool header_;
+        bool complexity_header_;
+        unsigned regressions_;
+        std::string baseline_;
+
+        static std::string fit(const stats::complexity_fit & f) {
+            std::ostringstream stm;
+            stm << duration(f.coefficient);
+            if (f.model != stats::o_1) stm << " * " << stats::term(f.model);
+            return stm.str();
+        }
+
+        static std::string indent(size_t chars = 8) { return std::string(chars, ' '); }
+
+        static std::string rate(double per_second) { return scaled(per_second) + "/s"; }
+
+        static std::string scaled(double v) {
+            static const char * units[] = { "", "k", "M", "G" };
+            auto u = 0;
+            for (; u < 3 && v >= 1000.0; u++) v /= 1000.0;
+            std::ostringstream stm;
+            stm << std::fixed << std::setprecision(2) << v << units[u];
+            return stm.str();
+        }
+
+        // Nanoseconds, in us, ms or s from 1000 up
+        static std::string duration(double ns) {
+            static const char * units[] = { "ns", "us", "ms", "s" };
+            auto u = 0;
+            for (; u < 3 && ns >= 1000.0; u++) ns /= 1000.0;
+            std::ostringstream stm;
+            stm << std::fixed << std::setprecision(2) << ns << units[u];
+            return stm.str();
+        }
+
+        // Whole numbers without decimals
+        static std::string count(double v) {
+            std::ostringstream stm;
+            stm << std::fixed << std::setprecision(v == std::floor(v) ? 0 : 2) << v;
+            return stm.str();
+        }
+
+        static std::string percent(double v) {
+            std::ostringstream stm;
+            stm << std::fixed << std::setprecision(2) << v * 100.0 << '%';
+            return stm.str();
+        }
+
+        std::string describe_outliers(const stats::summary & sum) const {
+            std::ostringstream stm;
+            stm << sum.mild() << " mild, " << sum.severe() << " severe (" << stats::name(ctx_.stats.outliers) 
+                << "), " << sum.excluded << " excluded";
+            return stm.str();
+        }
+
+        void verbose_summary(const fixture_result & res) {
+            const auto & sum = res.summary;
+            stm_ << std::endl
+                << indent() << "      min: " << as_cycles(sum.min) << std::endl
+                << indent() << "   median: " << as_cycles(sum.median) << ", " << ctx_.stats.confidence * 100.0 
+                    << "% CI [" << as_cycles(sum.ci_low) << ", " << as_cycles(sum.ci_high) << "]" << std::endl
+                << indent() << "      MAD: " << as_cycles(sum.mad) << std::endl
+                << indent() << "      avg: " << as_cycles(sum.mean) << std::endl
+                << indent() << "  trimmed: " << as_cycles(sum.trimmed_mean) << std::endl
+                << indent() << "  std_dev: " << as_cycles(sum.stddev) << std::endl
+                << indent() << "     % 75: " << as_cycles(sum.p75) << std::endl
+                << indent() << "     % 90: " << as_cycles(sum.p90) << std::endl
+                << indent() << "     % 99: " << as_cycles(sum.p99) << std::endl
+                << indent() << "      max: " << as_cycles(sum.max) << std::endl
+                << indent() << " outliers: " << describe_outliers(sum);
+            if (res.hist)
+                stm_ << std::endl << indent() << "histogram: " << sum.n << " runs, " << res.hist->digits() 
+                    << " significant digits";
+            if (res.threads)
+                stm_ << std::endl << indent() << "  threads: " << res.threads << ", " << rate(res.throughput) 
+                    << " calls in total";
+            if (res.batch > 1)
+                stm_ << std::endl << indent() << "    batch: " << res.batch << " calls/run";
+            if (ctx_.warmup)
+                stm_ << std::endl << indent() << "   warmup: " << res.warmup << " runs discarded"
+                    << (res.steady ? "" : " (not steady)");
+            if (res.stop)
+                stm_ << std::endl << indent() << "     runs: " << sum.n << " (" << res.stop << ")"
+                    << std::endl << indent() << "precision: +/-" << percent(res.precision) << " of " 
+                    << stats::name(ctx_.estimator);
+        }
+
+        void brief_summary(const fixture_result & res) {
+            const auto & sum = res.summary;
+            stm_ << ", median=" << as_cycles(sum.median) << ", avg=" << as_cycles(sum.mean) << " +/- " 
+                << as_cycles(sum.stddev) << ", range=[" << as_cycles(sum.min) << ", " << as_cycles(sum.max) << "]";
+            if (sum.excluded)
+                stm_ << ", outliers=" << sum.excluded;
+            if (res.threads)
+                stm_ << ", throughput=" << rate(res.throughput);
+            if (res.batch > 1)
+                stm_ << ", batch=" << res.batch;
+            if (ctx_.warmup)
+                stm_ << ", warmup=" << res.warmup << (res.steady ? "" : " (not steady)");
+            if (res.stop)
+                stm_ << ", runs=" << sum.n << " (" << res.stop << "), " << stats::name(ctx_.estimator) 
+                    << " +/-" << percent(res.precision);
+        }
+
+        void work(const fixture_result & res) {
+            if (res.items <= 0.0 && res.bytes <= 0.0) return;
+            std::ostringstream str;
+            str << std::fixed;
+            if (verbose_) {
+                str << std::endl << indent() << "     work: ";
+                if (res.items > 0.0) str << count(res.items) << " items/call" << (res.bytes > 0.0 ? ", " : "");
+                if (res.bytes > 0.0) str << count(res.bytes) << " bytes/call";
+                str << std::endl << indent() << "           ";
+            } else {
+                str << ", ";
+            }
+            if (res.items > 0.0) 
+                str << duration(ns_per_item(res)) << "/item, " << scaled(items_per_second(res)) << " items/s" 
+                    << (res.bytes > 0.0 ? ", " : "");
+            if (res.bytes > 0.0) str << std::setprecision(2) << gb_per_second(res) << "GB/s";
+            stm_ << str.str();
+        }
+
+        void counters(const fixture_result & res) {
+            const auto & ctrs = res.counters;
+            if (!ctx_.counters) return;
+            if (ctrs.empty()) {
+                stm_ << (verbose_ ? "\n" + indent() + " counters: not scheduled" : ", counters=n/a");
+                return;
+            }
+
+            std::ostringstream str;
+            str << std::fixed << std::setprecision(2);
+            if (verbose_) 
+                str << std::endl << indent() << "      ipc: " << ctrs.ipc();
+            else
+                str << ", ipc=" << ctrs.ipc();
+
+            for (auto i = static_cast<int>(ctr_l1d_misses); i < ctr_count; i++) {
+                auto id = static_cast<counter_id>(i);
+                if (!ctrs.has(id)) continue;
+                auto per_run = ctrs.per_run(id) / res.batch;
+                if (verbose_) 
+                    str << std::endl << indent() << std::setw(9) << counter_info(id).name << ": " 
+                        << std::setprecision(1) << per_run << "/run";
+                else 
+                    str << ", " << counter_info(id).name << "=" << std::setprecision(1) << per_run;
+                if (res.elements > 0.0) 
+                    str << (verbose_ ? ", " : " (") << std::setprecision(3) << per_run / res.elements 
+                        << "/elem" << (verbose_ ? "" : ")");
+            }
+
+            if (ctrs.multiplexed) {
+                if (verbose_)
+                    str << std::endl << indent() << "multiplex: " << ctrs.multiplexed << '/' << ctrs.runs
+                        << " runs scaled";
+                else
+                    str << ", multiplexed=" << ctrs.multiplexed << '/' << ctrs.runs;
+            }
+            stm_ << str.str();
+        }
+
+        void allocs(const fixture_result & res) {
+            if (!ctx_.allocs || res.allocs.empty()) return;
+            std::ostringstream str;
+            str << std::fixed;
+            for (auto i = 0; i < alloc_count; i++) {
+                auto id = static_cast<alloc_id>(i);
+                if (!res.allocs.has(id)) continue;
+                auto per_run = res.allocs.per_run(id) / res.batch;
+                if (verbose_) 
+                    str << std::endl << indent() << std::setw(12) << alloc_name(id) << ": " 
+                        << std::setprecision(1) << per_run << "/run";
+                else 
+                    str << ", " << alloc_name(id) << "=" << std::setprecision(1) << per_run;
+                if (res.elements > 0.0) 
+                    str << (verbose_ ? ", " : " (") << std::setprecision(3) << per_run / res.elements 
+                        << "/elem" << (verbose_ ? "" : ")");
+            }
+            stm_ << str.str();
+        }
+
+        void interference(const fixture_result & res) {
+            const auto & intf = res.interference;
+            if (!ctx_.interference || intf.empty()) return;
+            if (!verbose_) {
+                stm_ << ", interfered=" << percent(intf.rate());
+                if (intf.reruns) stm_ << " (" << intf.reruns << " rerun)";
+                if (intf.excluded) stm_ << " (" << intf.excluded << " excluded)";
+                return;
+            }
+            stm_ << std::endl << indent() << "interfered: " << intf.contaminated << '/' << intf.runs << " runs";
+            for (auto i = 0; i < intf_count; i++) 
+                stm_ << ", " << intf.events[i] << ' ' << interference_name(static_cast<interference_id>(i));
+            if (intf.reruns) stm_ << ", " << intf.reruns << " rerun";
+            if (intf.excluded) stm_ << ", " << intf.excluded << " excluded";
+        }
+    };
+
+    // A single JSON document. The context and results are written as they
+    // arrive; comparisons, scaling, complexity and regressions are small
+    // and buffered until end(), where they follow the results.
+    class json_reporter : public reporter {
+    public:
+        explicit json_reporter(std::ostream & stm) : reporter(stm), results_(0) { }
+
+        virtual void begin(const run_context & ctx) {
+            reporter::begin(ctx);
+            std::ostringstream str;     // leaves the precision of the caller's stream alone
+            str << std::setprecision(9) << "{\n  \"context\": {"
+                << "\"timer\": " << quote(ctx.timer) 
+                << ", \"tsc_mhz\": " << number(ctx.tsc.mhz) 
+                << ", \"tsc_source\": " << quote(ctx.tsc.source_name())
+                << ", \"tsc_invariant\": " << boolean(ctx.tsc.invariant)
+                << ", \"cpu\": " << quote(ctx.cpu)
+                << ", \"pincore\": " << ctx.pincore
+                << ", \"numruns\": " << ctx.numruns
+                << ", \"overhead_cycles\": " << ctx.overhead
+                << ", \"inline_overhead_cycles\": " << ctx.inline_overhead
+                << ", \"batch_cycles\": " << ctx.batch_cycles
+                << ", \"precision\": " << number(ctx.precision)
+                << ", \"estimator\": " << quote(stats::name(ctx.estimator))
+                << ", \"confidence\": " << number(ctx.stats.confidence)
+                << ", \"outliers\": " << quote(stats::name(ctx.stats.outliers))
+                << ", \"exclude_outliers\": " << quote(stats::name(ctx.stats.exclude))
+                << ", \"cache\": " << quote(ctx.cache)
+                << ",\n    \"environment\": {\"cpu\": " << quote(ctx.env.cpu)
+                << ", \"base_mhz\": " << ctx.env.base_mhz
+                << ", \"cpus\": " << ctx.env.cpus
+                << ", \"smt\": " << flag(ctx.env.smt)
+                << ", \"turbo\": " << flag(ctx.env.turbo)
+                << ", \"governor\": " << (ctx.env.governor.empty() ? "null" : quote(ctx.env.governor))
+                << ", \"isolated\": " << flag(ctx.env.isolated)
+                << ", \"irq_rate\": " << (ctx.env.irq_rate < 0.0 ? "null" : number(ctx.env.irq_rate))
+                << ", \"kernel\": " << quote(ctx.env.kernel)
+                << ", \"compiler\": " << quote(ctx.env.compiler)
+                << ", \"flags\": " << quote(ctx.env.flags) << "}"
+                << ", \"unit\": \"ns\"},\n  \"results\": [";
+            stm_ << str.str();
+        }
+
+        virtual void result(const fixture_result & res) {
+            const auto & sum = res.summary;
+            stm_ << (results_++ ? ",\n" : "\n") << "    {\"group\": " << quote(res.group) 
+                << ", \"name\": " << quote(res.name);
+            if (res.table) 
+                stm_ << ", \"param\": " << quote(res.param) << ", \"elements\": " << number(res.elements);
+            if (!res.params.empty()) {
+                stm_ << ", \"params\": {";
+                for (size_t i = 0; i < res.params.size(); i++)
+                    stm_ << (i ? ", " : "") << quote(res.params[i].label) << ": " << value(res.params[i]);
+                stm_ << "}";
+            }
+            if (res.threads)
+                stm_ << ", \"threads\": " << res.threads << ", \"throughput\": " << number(res.throughput);
+            if (res.cold)
+                stm_ << ", \"cache\": \"cold\"";
+            if (res.items > 0.0)
+                stm_ << ", \"items\": " << number(res.items) << ", \"ns_per_item\": " << number(ns_per_item(res))
+                    << ", \"items_per_second\": " << number(items_per_second(res));
+            if (res.bytes > 0.0)
+                stm_ << ", \"bytes\": " << number(res.bytes) << ", \"gb_per_second\": " << number(gb_per_second(res));
+            stm_ << ", \"runs\": " << sum.n << ", \"batch\": " << res.batch
+                << ", \"warmup\": " << res.warmup << ", \"steady\": " << boolean(res.steady)
+                << ", \"stop\": " << quote(res.stop ? res.stop : "fixed") << ", \"precision\": " << number(res.precision)
+                << ",\n     \"stats\": {\"min\": " << number(ns(sum.min)) << ", \"median\": " << number(ns(sum.median))
+                << ", \"ci_low\": " << number(ns(sum.ci_low)) << ", \"ci_high\": " << number(ns(sum.ci_high))
+                << ", \"mad\": " << number(ns(sum.mad)) << ", \"mean\": " << number(ns(sum.mean))
+                << ", \"stddev\": " << number(ns(sum.stddev)) << ", \"trimmed_mean\": " << number(ns(sum.trimmed_mean))
+                << ", \"p75\": " << number(ns(sum.p75)) << ", \"p90\": " << number(ns(sum.p90))
+                << ", \"p99\": " << number(ns(sum.p99)) << ", \"max\": " << number(ns(sum.max))
+                << ", \"outliers\": {\"mild_low\": " << sum.mild_low << ", \"mild_high\": " << sum.mild_high
+                << ", \"severe_low\": " << sum.severe_low << ", \"severe_high\": " << sum.severe_high
+                << ", \"excluded\": " << sum.excluded << "}}";
+            if (ctx_.counters && !res.counters.empty()) {
+                stm_ << ",\n     \"counters\": {\"runs\": " << res.counters.runs 
+                    << ", \"multiplexed\": " << res.counters.multiplexed;
+                for (auto i = 0; i < ctr_count; i++) {
+                    auto id = static_cast<counter_id>(i);
+                    if (res.counters.has(id)) 
+                        stm_ << ", " << quote(counter_info(id).name) << ": " << number(res.counters.per_run(id) / res.batch);
+                }
+                stm_ << "}";
+            }
+            if (ctx_.interference && !res.interference.empty()) {
+                const auto & intf = res.interference;
+                stm_ << ",\n     \"interference\": {\"runs\": " << intf.runs << ", \"contaminated\": " << intf.contaminated
+                    << ", \"rate\": " << number(intf.rate()) << ", \"reruns\": " << intf.reruns 
+                    << ", \"excluded\": " << intf.excluded;
+                for (auto i = 0; i < intf_count; i++)
+                    stm_ << ", " << quote(interference_name(static_cast<interference_id>(i))) << ": " << intf.events[i];
+                stm_ << "}";
+            }
+            if (ctx_.allocs && !res.allocs.empty()) {
+                stm_ << ",\n     \"allocs\": {\"runs\": " << res.allocs.runs;
+                for (auto i = 0; i < alloc_count; i++) {
+                    auto id = static_cast<alloc_id>(i);
+                    if (res.allocs.has(id)) 
+                        stm_ << ", " << quote(alloc_name(id)) << ": " << number(res.allocs.per_run(id) / res.batch);
+                }
+                stm_ << "}";
+            }
+            if (res.hist) {
+                stm_ << ",\n     \"histogram\": {\"digits\": " << res.hist->digits() << ", \"buckets\": [";
+                auto first = true;
+                res.hist->for_each([&](double v, uint64_t c) {
+                            stm_ << (first ? "" : ", ") << '[' << number(ns(v / res.batch)) << ", " << c << ']';
+                            first = false;
+                        });
+                stm_ << "]}";
+            }
+            stm_ << ",\n     \"samples\": [";
+            for (size_t i = 0; i < res.samples.size(); i++)
+                stm_ << (i ? ", " : "") << number(ns(res.samples[i]));
+            stm_ << "]}";
+        }
+
+        virtual void comparison(const comparison_result & res) {
+            std::ostringstream str;
+            str << std::setprecision(9) << "{\"group\": " << quote(res.group) << ", \"baseline\": " << quote(res.baseline) 
+                << ", \"name\": " << quote(res.name);
+            if (res.table) str << ", \"param\": " << quote(res.param);
+            if (res.threads) str << ", \"threads\": " << res.threads;
+            if (res.cold) str << ", \"cache\": \"cold\"";
+            if (res.per_item) str << ", \"per_item\": true";
+            str << ", \"ratio\": " << number(res.cmp.ratio) << ", \"ci_low\": " << number(res.cmp.ci_low) 
+                << ", \"ci_high\": " << number(res.cmp.ci_high) << ", \"p_value\": " << number(res.cmp.p_value) 
+                << ", \"significant\": " << boolean(res.cmp.significant) << "}";
+            comparisons_.push_back(str.str());
+        }
+
+        virtual void scaling(const scaling_result & res) {
+            std::ostringstream str;
+            str << std::setprecision(9) << "{\"group\": " << quote(res.group) << ", \"name\": " << quote(res.name);
+            if (res.table) str << ", \"param\": " << quote(res.param);
+            if (res.cold) str << ", \"cache\": \"cold\"";
+            str << ", \"points\": [";
+            for (size_t i = 0; i < res.points.size(); i++) {
+                const auto & p = res.points[i];
+                str << (i ? ", " : "") << "{\"threads\": " << p.threads << ", \"throughput\": " << number(p.throughput) 
+                    << ", \"speedup\": " << number(p.speedup) << ", \"efficiency\": " << number(p.efficiency)
+                    << ", \"latency\": " << number(ns(p.latency)) << "}";
+            }
+            str << "]}";
+            scaling_.push_back(str.str());
+        }
+
+        virtual void complexity(const complexity_result & res) {
+            std::ostringstream str;
+            str << std::setprecision(9) << "{\"group\": " << quote(res.group) << ", \"name\": " << quote(res.name);
+            if (!res.param.empty()) str << ", \"param\": " << quote(res.param);
+            if (res.threads) str << ", \"threads\": " << res.threads;
+            if (res.cold) str << ", \"cache\": \"cold\"";
+            str << ", " << fit("", res.fit);
+            if (res.saved) str << ", " << fit("baseline_", res.baseline) << ", \"regression\": " << boolean(res.regression);
+            str << "}";
+            complexity_.push_back(str.str());
+        }
+
+        virtual void regression(const regression_result & res) {
+            std::ostringstream str;
+            str << std::setprecision(9) << "{\"group\": " << quote(res.group) << ", \"name\": " << quote(res.name);
+            if (res.table) str << ", \"param\": " << quote(res.param);
+            if (res.threads) str << ", \"threads\": " << res.threads;
+            if (res.cold) str << ", \"cache\": \"cold\"";
+            if (res.per_item) str << ", \"per_item\": true";
+            if (!res.current)
+                str << ", \"baseline\": " << number(res.baseline_ns);
+            else {
+                if (res.saved)
+                    str << ", \"baseline\": " << number(res.baseline_ns) << ", \"change\": " << number(res.change);
+                str << ", \"current\": " << number(res.current_ns) << ", \"tolerance\": " << number(res.tolerance);
+            }
+            str << ", \"status\": " << quote(res.status) << ", \"regression\": " << boolean(res.regression) << "}";
+            regressions_.push_back(str.str());
+        }
+
+        virtual void end() {
+            stm_ << "\n  ],\n  \"comparisons\": [";
+            list(comparisons_);
+            stm_ << "],\n  \"scaling\": [";
+            list(scaling_);
+            stm_ << "],\n  \"complexity\": [";
+            list(complexity_);
+            stm_ << "],\n  \"regressions\": [";
+            list(regressions_);
+            stm_ << "]\n}" << std::endl;
+            reporter::end();
+        }
+
+    private:
+        size_t results_;
+        std::vector<std::string> comparisons_;
+        std::vector<std::string> scaling_;
+        std::vector<std::string> complexity_;
+        std::vector<std::string> regressions_;
+
+        static std::string fit(const std::string & prefix, const stats::complexity_fit & f) {
+            std::ostringstream str;
+            str << std::setprecision(9) << "\"" << prefix << "model\": " << quote(stats::name(f.model)) 
+                << ", \"" << prefix << "coefficient_ns\": " << number(f.coefficient) 
+                << ", \"" << prefix << "rms\": " << number(f.rms);
+            return str.str();
+        }
+
+        void list(const std::vector<std::string> & items) {
+            for (size_t i = 0; i < items.size(); i++)
+                stm_ << (i ? ",\n    " : "\n    ") << items[i];
+            if (!items.empty()) stm_ << "\n  ";
+        }
+
+        static std::string quote(const std::string & str) {
+            std::ostringstream res;
+            res << '"';
+            for (unsigned char c : str) {
+                switch (c) {
+                    case '"': res << "\\\""; break;
+                    case '\\': res << "\\\\"; break;
+                    case '\n': res << "\\n"; break;
+                    case '\t': res << "\\t"; break;
+                    default:
+                        if (c < 0x20) 
+                            res << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) 
+                                << std::dec << std::setfill(' ');
+                        else
+                            res << c;
+                }
+            }
+            res << '"';
+            return res.str();
+        }
+
+        static std::string number(double v) {
+            if (!std::isfinite(v)) return "null";
+            std::ostringstream res;
+            res << std::setprecision(9) << v;
+            return res.str();
+        }
+
+        static const char * boolean(bool v) { return v ? "true" : "false"; }
+
+        // A value of a numeric dimension as a number, anything else quoted
+        static std::string value(const param_value & p) {
+            if (!p.number) return quote(p.value);
+            return std::isfinite(std::strtod(p.value.c_str(), nullptr)) ? p.value : "null";
+        }
+
+        // A setting that may be unknown (< 0)
+        static const char * flag(int v) { return v < 0 ? "null" : boolean(v != 0); }
+    };
+
+    // One row per fixture and table parameter, times in ns
+    class csv_reporter : public reporter {
+    public:
+        explicit csv_reporter(std::ostream & stm) : reporter(stm) { }
+
+        virtual void begin(const run_context & ctx) {
+            reporter::begin(ctx);
+            stm_ << "group,fixture,param,elements,threads,throughput,cache,ns_per_item,items_per_s,gb_per_s,timer,runs,batch,warmup,steady,min_ns,median_ns,ci_low_ns,ci_high_ns,"
+                    "mad_ns,mean_ns,stddev_ns,trimmed_mean_ns,p75_ns,p90_ns,p99_ns,max_ns,mild_outliers,"
+                    "severe_outliers,excluded";
+            if (ctx.counters)
+                for (auto i = 0; i < ctr_count; i++) 
+                    stm_ << ',' << counter_info(static_cast<counter_id>(i)).name;
+            if (ctx.allocs)
+                for (auto i = 0; i < alloc_count; i++) 
+                    stm_ << ',' << alloc_name(static_cast<alloc_id>(i));
+            if (ctx.interference)
+                stm_ << ",interfered,reruns,interfered_excluded";
+            stm_ << ",cpu,cpus,base_mhz,smt,turbo,governor,pincore,isolated,irq_per_s,kernel,compiler,flags\n" 
+                << std::setprecision(9);
+
+            // The same for every row, so each row stands on its own
+            const auto & env = ctx.env;
+            std::ostringstream str;
+            str << ',' << detail::csv_quote(env.cpu) << ',' << env.cpus << ',';
+            if (env.base_mhz) str << env.base_mhz;
+            str << ',' << setting(env.smt) << ',' << setting(env.turbo) << ',' << detail::csv_quote(env.governor) 
+                << ',' << ctx.pincore << ',' << setting(env.isolated) << ',';
+            if (env.irq_rate >= 0.0) str << static_cast<uint64_t>(env.irq_rate);
+            str << ',' << detail::csv_quote(env.kernel) << ',' << detail::csv_quote(env.compiler) 
+                << ',' << detail::csv_quote(env.flags);
+            env_ = str.str();
+        }
+
+        virtual void result(const fixture_result & res) {
+            const auto & sum = res.summary;
+            stm_ << detail::csv_quote(res.group) << ',' << detail::csv_quote(res.name) << ',' << detail::csv_quote(res.param) << ',';
+            if (res.table) stm_ << res.elements;
+            stm_ << ',' << res.threads << ',';
+            if (res.threads) stm_ << res.throughput;
+            stm_ << ',' << (res.cold ? "cold" : "warm") << ',';
+            if (res.items > 0.0) stm_ << ns_per_item(res) << ',' << items_per_second(res);
+            else stm_ << ',';
+            stm_ << ',';
+            if (res.bytes > 0.0) stm_ << gb_per_second(res);
+            stm_ << ',' << ctx_.timer << ',' << sum.n << ',' << res.batch << ',' << res.warmup << ',' 
+                << res.steady << ',' << ns(sum.min) << ',' << ns(sum.median) << ',' << ns(sum.ci_low) << ',' 
+                << ns(sum.ci_high) << ',' << ns(sum.mad) << ',' << ns(sum.mean) << ',' << ns(sum.stddev) << ',' 
+                << ns(sum.trimmed_mean) << ',' << ns(sum.p75) << ',' << ns(sum.p90) << ',' << ns(sum.p99) << ',' 
+                << ns(sum.max) << ',' << sum.mild() << ',' << sum.severe() << ',' << sum.excluded;
+            if (ctx_.counters)
+                for (auto i = 0; i < ctr_count; i++) {
+                    auto id = static_cast<counter_id>(i);
+                    stm_ << ',';
+                    if (res.counters.has(id)) stm_ << res.counters.per_run(id) / res.batch;
+                }
+            if (ctx_.allocs)
+                for (auto i = 0; i < alloc_count; i++) {
+                    auto id = static_cast<alloc_id>(i);
+                    stm_ << ',';
+                    if (res.allocs.has(id)) stm_ << res.allocs.per_run(id) / res.batch;
+                }
+            if (ctx_.interference)
+                stm_ << ',' << res.interference.rate() << ',' << res.interference.reruns << ',' << res.interference.excluded;
+            stm_ << env_ << '\n';
+        }
+
+    private:
+        std::string env_;
+
+        // 0 or 1, empty if unknown (< 0)
+        static std::string setting(int v) { return v < 0 ? "" : std::to_string(v); }
+    };
+
+    namespace report {
+        enum format { console, json, csv };
+
+        inline const char * name(format f) {
+            static const char * names[] = { "console", "json", "csv" };
+            return names[f];
+        }
+
+        inline bool parse(const std::string & str, format & res) {
+            if (str == "console") res = console;
+            else if (str == "json") res = json;
+            else if (str == "csv") res = csv;
+            else return false;
+            return true;
+        }
+
+        inline std::unique_ptr<reporter> make(format f, std::ostream & stm, bool verbose) {
+            switch (f) {
+                case json: return std::unique_ptr<reporter>(new json_reporter(stm));
+                case csv: return std::unique_ptr<reporter>(new csv_reporter(stm));
+                default: return std::unique_ptr<reporter>(new console_reporter(stm, verbose));
+            }
+        }
+    }
+}
+
+#endif // MBM_REPORTER_HPP_
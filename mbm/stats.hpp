@@ -0,0 +1,543 @@
+// =====================================================================================
+// 
+//       Filename:  stats.hpp
+// 
+//    Description:  Sample statistics
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 01:37:12 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_STATS_HPP_
+#define MBM_STATS_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "histogram.hpp"
+
+namespace mbm {
+namespace stats {
+    enum estimator { median, mean };
+
+    inline const char * name(estimator e) { return e == median ? "median" : "mean"; }
+
+    inline bool parse(const std::string & str, estimator & res) {
+        if (str == "median") res = median;
+        else if (str == "mean") res = mean;
+        else return false;
+        return true;
+    }
+
+    // z for a two sided 95% interval
+    const double z95 = 1.959964;
+
+    // Relative half width of the 95% confidence interval of the estimator.
+    // The median interval is distribution free (order statistics around n/2),
+    // the mean interval uses the normal approximation.
+    inline double relative_ci(std::vector<double> values, estimator e) {
+        auto n = values.size();
+        if (n < 2) return std::numeric_limits<double>::infinity();
+
+        if (e == mean) {
+            auto avg = std::accumulate(std::begin(values), std::end(values), 0.0) / n;
+            auto ss = std::accumulate(std::begin(values), std::end(values), 0.0, 
+                    [avg](double r, double v) { return r + (v - avg) * (v - avg); });
+            auto sem = std::sqrt(ss / (n - 1) / n);
+            return avg > 0.0 ? z95 * sem / avg : std::numeric_limits<double>::infinity();
+        }
+
+        std::sort(std::begin(values), std::end(values));
+        auto half = z95 * std::sqrt(static_cast<double>(n)) / 2.0;
+        auto lo = static_cast<size_t>(std::max(0.0, std::floor(n / 2.0 - half)));
+        auto hi = std::min(n - 1, static_cast<size_t>(std::ceil(n / 2.0 + half)));
+        auto mid = values[n / 2];
+        return mid > 0.0 ? (values[hi] - values[lo]) / 2.0 / mid : std::numeric_limits<double>::infinity();
+    }
+
+    // Linearly interpolated quantile (Hyndman & Fan type 7) of sorted values
+    inline double quantile(const std::vector<double> & sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        auto h = (sorted.size() - 1) * std::min(1.0, std::max(0.0, p));
+        auto lo = static_cast<size_t>(std::floor(h));
+        auto hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (h - lo) * (sorted[hi] - sorted[lo]);
+    }
+
+    // P(X >= m) for X ~ Binomial(n, p); exact for small n, normal
+    // approximation with continuity correction otherwise
+    inline double binomial_upper_tail(size_t n, double p, size_t m) {
+        if (m == 0 || p >= 1.0) return 1.0;
+        if (m > n || p <= 0.0) return 0.0;
+        if (n <= 200) {
+            auto lp = std::log(p), lq = std::log1p(-p), lnf = std::lgamma(n + 1.0);
+            auto res = 0.0;
+            for (auto k = m; k <= n; k++)
+                res += std::exp(lnf - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0) + k * lp + (n - k) * lq);
+            return std::min(1.0, res);
+        }
+        auto z = (m - 0.5 - n * p) / std::sqrt(n * p * (1.0 - p));
+        return 0.5 * std::erfc(z / std::sqrt(2.0));
+    }
+
+    // Exact bootstrap distribution of the (lower) median of a sorted sample.
+    // The median of a resample is <= x(r) iff at least (n+1)/2 of the n
+    // draws fall at or below rank r, which is binomial, so percentile
+    // intervals and bootstrap draws cost O(log n) each instead of O(n).
+    class median_bootstrap {
+    public:
+        explicit median_bootstrap(const std::vector<double> & sorted) : sorted_(sorted), cdf_(sorted.size()) { 
+            auto n = sorted.size();
+            for (auto r = 1u; r <= n; r++)
+                cdf_[r - 1] = binomial_upper_tail(n, static_cast<double>(r) / n, (n + 1) / 2);
+        }
+
+        // P(median* <= x(rank)), rank is 1 based
+        double cdf(size_t rank) const { return cdf_[rank - 1]; }
+
+        double quantile(double q) const {
+            if (sorted_.empty()) return 0.0;
+            auto it = std::lower_bound(std::begin(cdf_), std::end(cdf_), q);
+            auto rank = std::min<size_t>(it - std::begin(cdf_), sorted_.size() - 1);
+            return sorted_[rank];
+        }
+
+        template<typename Rng>
+        double draw(Rng & rng) const {
+            return quantile(std::uniform_real_distribution<double>(0.0, 1.0)(rng));
+        }
+
+    private:
+        const std::vector<double> & sorted_;
+        std::vector<double> cdf_;
+    };
+
+    enum outlier_method { tukey, mad };
+
+    inline const char * name(outlier_method m) { return m == tukey ? "tukey" : "mad"; }
+
+    inline bool parse(const std::string & str, outlier_method & res) {
+        if (str == "tukey") res = tukey;
+        else if (str == "mad") res = mad;
+        else return false;
+        return true;
+    }
+
+    enum exclusion { exclude_none, exclude_severe, exclude_all };
+
+    inline const char * name(exclusion e) {
+        static const char * names[] = { "none", "severe", "all" };
+        return names[e];
+    }
+
+    inline bool parse(const std::string & str, exclusion & res) {
+        if (str == "none") res = exclude_none;
+        else if (str == "severe") res = exclude_severe;
+        else if (str == "all") res = exclude_all;
+        else return false;
+        return true;
+    }
+
+    struct config {
+        outlier_method outliers;
+        exclusion exclude;   // outliers left out of mean and stddev
+        double trim;         // fraction trimmed from each end for the trimmed mean
+        double confidence;
+
+        config() : outliers(tukey), exclude(exclude_severe), trim(0.1), confidence(0.95) { }
+    };
+
+    struct summary {
+        size_t n;
+        double min, max;
+        double median, mad;
+        double ci_low, ci_high;     // bootstrap interval of the median
+        double mean, stddev;        // over samples that were not excluded
+        double trimmed_mean;
+        double p75, p90, p99;
+        size_t mild_low, mild_high, severe_low, severe_high;
+        size_t excluded;
+
+        summary() : n(0), min(0), max(0), median(0), mad(0), ci_low(0), ci_high(0), mean(0), stddev(0), 
+            trimmed_mean(0), p75(0), p90(0), p99(0), mild_low(0), mild_high(0), severe_low(0), severe_high(0), 
+            excluded(0) { }
+
+        size_t mild() const { return mild_low + mild_high; }
+        size_t severe() const { return severe_low + severe_high; }
+
+        // Rescale every value, e.g. from cycles per run to cycles per call
+        summary & scale(double f) {
+            for (auto v : { &min, &max, &median, &mad, &ci_low, &ci_high, &mean, &stddev, &trimmed_mean, &p75, &p90, &p99 })
+                *v *= f;
+            return *this;
+        }
+    };
+
+    struct fences {
+        double mild_lo, mild_hi, severe_lo, severe_hi;
+
+        fences(const config & cfg, double q1, double q3, double median, double mad) {
+            if (cfg.outliers == tukey) {
+                auto iqr = q3 - q1;
+                mild_lo = q1 - 1.5 * iqr;
+                mild_hi = q3 + 1.5 * iqr;
+                severe_lo = q1 - 3.0 * iqr;
+                severe_hi = q3 + 3.0 * iqr;
+            } else {
+                auto sigma = 1.4826 * mad;  // consistent with stddev for normal data
+                mild_lo = median - 3.0 * sigma;
+                mild_hi = median + 3.0 * sigma;
+                severe_lo = median - 5.0 * sigma;
+                severe_hi = median + 5.0 * sigma;
+            }
+        }
+    };
+
+    // Median absolute deviation in O(n): deviations from the median grow
+    // monotonically walking outwards from the middle of the sorted data, so
+    // the two sides can be merged up to the middle rank
+    inline double median_abs_deviation(const std::vector<double> & sorted, double median) {
+        auto n = sorted.size();
+        if (!n) return 0.0;
+        auto right = static_cast<size_t>(std::lower_bound(std::begin(sorted), std::end(sorted), median) - std::begin(sorted));
+        auto left = right;   // next candidate below is left - 1
+        auto next = [&]() {
+            if (left == 0) return sorted[right++] - median;
+            if (right == n) return median - sorted[--left];
+            auto dl = median - sorted[left - 1], dr = sorted[right] - median;
+            if (dl <= dr) { --left; return dl; }
+            ++right;
+            return dr;
+        };
+        double lo = 0.0;
+        for (auto i = 0u; i <= (n - 1) / 2; i++) lo = next();
+        return n % 2 ? lo : (lo + next()) / 2.0;
+    }
+
+    // Everything below is computed from one sorted copy: quantiles are O(1)
+    // lookups and a single pass classifies outliers and accumulates moments
+    inline summary summarize(std::vector<double> values, const config & cfg = config()) {
+        summary res;
+        res.n = values.size();
+        if (!res.n) return res;
+
+        std::sort(std::begin(values), std::end(values));
+        const auto & sorted = values;
+        res.min = sorted.front();
+        res.max = sorted.back();
+        res.median = quantile(sorted, 0.5);
+        res.p75 = quantile(sorted, 0.75);
+        res.p90 = quantile(sorted, 0.90);
+        res.p99 = quantile(sorted, 0.99);
+        res.mad = median_abs_deviation(sorted, res.median);
+
+        median_bootstrap boot(sorted);
+        auto alpha = 1.0 - cfg.confidence;
+        res.ci_low = boot.quantile(alpha / 2.0);
+        res.ci_high = boot.quantile(1.0 - alpha / 2.0);
+
+        fences f(cfg, quantile(sorted, 0.25), quantile(sorted, 0.75), res.median, res.mad);
+
+        auto trim = static_cast<size_t>(res.n * std::min(0.49, std::max(0.0, cfg.trim)));
+        double trimmed = 0.0, mean = 0.0, m2 = 0.0;
+        size_t count = 0;
+        for (auto i = 0u; i < res.n; i++) {
+            auto v = sorted[i];
+            auto severe = v < f.severe_lo || v > f.severe_hi;
+            auto mild = !severe && (v < f.mild_lo || v > f.mild_hi);
+            if (severe) (v < f.severe_lo ? res.severe_low : res.severe_high)++;
+            if (mild) (v < f.mild_lo ? res.mild_low : res.mild_high)++;
+            if (i >= trim && i < res.n - trim) trimmed += v;
+
+            if ((severe && cfg.exclude != exclude_none) || (mild && cfg.exclude == exclude_all)) {
+                res.excluded++;
+                continue;
+            }
+            // Welford
+            count++;
+            auto delta = v - mean;
+            mean += delta / count;
+            m2 += delta * (v - mean);
+        }
+        res.trimmed_mean = trimmed / (res.n - 2 * trim);
+        res.mean = mean;
+        res.stddev = count ? std::sqrt(m2 / count) : 0.0;
+        return res;
+    }
+
+    // median_abs_deviation over the (value, count) buckets of a histogram
+    inline double median_abs_deviation(const std::vector<std::pair<double, uint64_t>> & buckets, uint64_t n, 
+                                       double median) {
+        if (!n) return 0.0;
+        auto right = static_cast<size_t>(std::lower_bound(std::begin(buckets), std::end(buckets), 
+                    std::make_pair(median, uint64_t(0))) - std::begin(buckets));
+        auto left = right;
+        auto next = [&](uint64_t & c) {
+            if (left == 0 || (right < buckets.size() && buckets[right].first - median < median - buckets[left - 1].first)) {
+                c = buckets[right].second;
+                return buckets[right++].first - median;
+            }
+            c = buckets[--left].second;
+            return median - buckets[left].first;
+        };
+        auto r = (n - 1) / 2;
+        double lo = 0.0, hi = 0.0;
+        auto found = false;
+        for (uint64_t seen = 0; ; ) {
+            uint64_t c;
+            auto d = next(c);
+            if (!found && seen + c > r) {
+                lo = d;
+                found = true;
+                if (n % 2) return lo;
+            }
+            if (seen + c > r + 1) {
+                hi = d;
+                break;
+            }
+            seen += c;
+        }
+        return (lo + hi) / 2.0;
+    }
+
+    // summarize for a histogram, with bucket midpoints standing in for the
+    // values. Quantiles are within the histogram precision, the median
+    // interval follows median_bootstrap and, unless outliers are excluded,
+    // the mean and stddev are exact.
+    inline summary summarize(const histogram & h, const config & cfg = config()) {
+        summary res;
+        res.n = h.count();
+        if (!res.n) return res;
+
+        std::vector<std::pair<double, uint64_t>> buckets;
+        h.for_each([&](double v, uint64_t c) { buckets.emplace_back(v, c); });
+
+        uint64_t n = res.n;
+        res.min = h.min();
+        res.max = h.max();
+        res.median = h.quantile(0.5);
+        res.p75 = h.quantile(0.75);
+        res.p90 = h.quantile(0.90);
+        res.p99 = h.quantile(0.99);
+        res.mad = median_abs_deviation(buckets, n, res.median);
+
+        // smallest (1 based) rank with P(median* <= x(rank)) >= q
+        auto boot_rank = [n](double q) {
+            uint64_t lo = 1, hi = n;
+            while (lo < hi) {
+                auto mid = lo + (hi - lo) / 2;
+                if (binomial_upper_tail(n, static_cast<double>(mid) / n, (n + 1) / 2) >= q) hi = mid;
+                else lo = mid + 1;
+            }
+            return lo;
+        };
+        auto alpha = 1.0 - cfg.confidence;
+        res.ci_low = h.at_rank(boot_rank(alpha / 2.0) - 1);
+        res.ci_high = h.at_rank(boot_rank(1.0 - alpha / 2.0) - 1);
+
+        fences f(cfg, h.quantile(0.25), res.p75, res.median, res.mad);
+        auto trim = static_cast<uint64_t>(n * std::min(0.49, std::max(0.0, cfg.trim)));
+        double trimmed = 0.0, mean = 0.0, m2 = 0.0;
+        uint64_t count = 0, rank = 0;
+        for (const auto & b : buckets) {
+            auto v = b.first;
+            auto c = b.second;
+            auto severe = v < f.severe_lo || v > f.severe_hi;
+            auto mild = !severe && (v < f.mild_lo || v > f.mild_hi);
+            if (severe) (v < f.severe_lo ? res.severe_low : res.severe_high) += c;
+            if (mild) (v < f.mild_lo ? res.mild_low : res.mild_high) += c;
+            auto first = std::max(rank, trim), last = std::min(rank + c, n - trim);
+            if (last > first) trimmed += v * (last - first);
+            rank += c;
+
+            if ((severe && cfg.exclude != exclude_none) || (mild && cfg.exclude == exclude_all)) {
+                res.excluded += c;
+                continue;
+            }
+            // Welford, c observations at once
+            count += c;
+            auto delta = v - mean;
+            mean += delta * c / count;
+            m2 += c * delta * (v - mean);
+        }
+        res.trimmed_mean = trimmed / (n - 2 * trim);
+        res.mean = res.excluded ? mean : h.mean();
+        res.stddev = res.excluded ? (count ? std::sqrt(m2 / count) : 0.0) : h.stddev();
+        return res;
+    }
+
+    // relative_ci for a histogram
+    inline double relative_ci(const histogram & h, estimator e) {
+        auto n = h.count();
+        if (n < 2) return std::numeric_limits<double>::infinity();
+
+        if (e == mean) {
+            auto avg = h.mean();
+            auto sem = h.stddev() * std::sqrt(n / (n - 1.0)) / std::sqrt(static_cast<double>(n));
+            return avg > 0.0 ? z95 * sem / avg : std::numeric_limits<double>::infinity();
+        }
+
+        auto half = z95 * std::sqrt(static_cast<double>(n)) / 2.0;
+        auto lo = static_cast<uint64_t>(std::max(0.0, std::floor(n / 2.0 - half)));
+        auto hi = std::min(n - 1, static_cast<uint64_t>(std::ceil(n / 2.0 + half)));
+        auto mid = h.at_rank(n / 2);
+        return mid > 0.0 ? (h.at_rank(hi) - h.at_rank(lo)) / 2.0 / mid : std::numeric_limits<double>::infinity();
+    }
+
+    // Two sided Mann-Whitney U test p value, normal approximation with tie
+    // correction. Both inputs must be sorted.
+    inline double mann_whitney(const std::vector<double> & a, const std::vector<double> & b) {
+        double n1 = a.size(), n2 = b.size(), n = n1 + n2;
+        if (!n1 || !n2) return 1.0;
+
+        // Walk the merged order assigning mid ranks to runs of ties
+        double rank_sum = 0.0, ties = 0.0;
+        size_t i = 0, j = 0;
+        while (i < a.size() || j < b.size()) {
+            auto v = j == b.size() || (i < a.size() && a[i] <= b[j]) ? a[i] : b[j];
+            size_t ta = 0, tb = 0;
+            while (i < a.size() && a[i] == v) { i++; ta++; }
+            while (j < b.size() && b[j] == v) { j++; tb++; }
+            double t = ta + tb;
+            auto first = i + j - t + 1;
+            rank_sum += ta * (first + (t - 1) / 2.0);
+            ties += t * t * t - t;
+        }
+
+        auto u = rank_sum - n1 * (n1 + 1) / 2.0;
+        auto mu = n1 * n2 / 2.0;
+        auto sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1))));
+        if (sigma == 0.0) return 1.0;
+        auto z = (std::fabs(u - mu) - 0.5) / sigma;
+        return std::min(1.0, std::erfc(std::max(0.0, z) / std::sqrt(2.0)));
+    }
+
+    struct comparison {
+        double ratio;             // baseline median / candidate median, > 1 is faster
+        double ci_low, ci_high;   // bootstrap interval of the ratio
+        double p_value;           // Mann-Whitney U
+        bool significant;         // p below alpha and the interval excludes 1
+
+        int direction() const { return significant ? (ratio > 1.0 ? 1 : -1) : 0; }
+    };
+
+    // Speedup of candidate over baseline. Bootstrap medians of each side
+    // are drawn from their exact distributions, so the cost is independent
+    // of the sample counts.
+    inline comparison compare(std::vector<double> baseline, std::vector<double> candidate, 
+                              const config & cfg = config(), unsigned resamples = 2000) {
+        comparison res;
+        std::sort(std::begin(baseline), std::end(baseline));
+        std::sort(std::begin(candidate), std::end(candidate));
+        res.p_value = mann_whitney(baseline, candidate);
+
+        auto b = quantile(baseline, 0.5), c = quantile(candidate, 0.5);
+        res.ratio = c > 0.0 ? b / c : std::numeric_limits<double>::infinity();
+
+        median_bootstrap bb(baseline), cb(candidate);
+        std::mt19937_64 rng(0x6d626d);
+        std::vector<double> ratios;
+        ratios.reserve(resamples);
+        for (auto i = 0u; i < resamples; i++) {
+            auto cd = cb.draw(rng);
+            ratios.push_back(cd > 0.0 ? bb.draw(rng) / cd : std::numeric_limits<double>::infinity());
+        }
+        std::sort(std::begin(ratios), std::end(ratios));
+        auto alpha = 1.0 - cfg.confidence;
+        res.ci_low = quantile(ratios, alpha / 2.0);
+        res.ci_high = quantile(ratios, 1.0 - alpha / 2.0);
+        res.significant = res.p_value < alpha && (res.ci_low > 1.0 || res.ci_high < 1.0);
+        return res;
+    }
+
+    enum complexity { o_1, o_log_n, o_n, o_n_log_n, o_n_squared, complexity_count };
+
+    inline const char * name(complexity c) {
+        static const char * names[complexity_count] = { "O(1)", "O(log n)", "O(n)", "O(n log n)", "O(n^2)" };
+        return names[c];
+    }
+
+    // The term of n a model scales with, "1" for O(1)
+    inline const char * term(complexity c) {
+        static const char * terms[complexity_count] = { "1", "log n", "n", "n log n", "n^2" };
+        return terms[c];
+    }
+
+    inline double term(complexity c, double n) {
+        switch (c) {
+            case o_1: return 1.0;
+            case o_log_n: return std::log2(n);
+            case o_n: return n;
+            case o_n_log_n: return n * std::log2(n);
+            default: return n * n;
+        }
+    }
+
+    struct complexity_fit {
+        complexity model;
+        double coefficient;  // time per unit of the term
+        double rms;          // RMS residual relative to the mean time
+    };
+
+    // Least squares fit of t = coefficient * term(n) through the origin
+    inline complexity_fit fit(complexity model, const std::vector<double> & n, const std::vector<double> & t) {
+        double tg = 0.0, gg = 0.0, mean = 0.0;
+        for (size_t i = 0; i < n.size(); i++) {
+            auto g = term(model, n[i]);
+            tg += t[i] * g;
+            gg += g * g;
+            mean += t[i];
+        }
+        mean /= n.size();
+        complexity_fit res { model, gg > 0.0 ? tg / gg : 0.0, 0.0 };
+        for (size_t i = 0; i < n.size(); i++) {
+            auto e = t[i] - res.coefficient * term(model, n[i]);
+            res.rms += e * e;
+        }
+        res.rms = mean > 0.0 ? std::sqrt(res.rms / n.size()) / mean : 0.0;
+        return res;
+    }
+
+    // The model with the lowest RMS residual, the lower order one on a tie.
+    // n must have at least three distinct values to tell the models apart.
+    inline complexity_fit fit_complexity(const std::vector<double> & n, const std::vector<double> & t) {
+        auto res = fit(o_1, n, t);
+        for (auto c = 1; c < complexity_count; c++) {
+            auto f = fit(static_cast<complexity>(c), n, t);
+            if (f.rms < res.rms) res = f;
+        }
+        return res;
+    }
+
+    // Whether t fits model a decisively better than model b: b leaves at
+    // least margin times the RMS residual of a. Residuals under floor count
+    // as floor, so two close fits of the same data are not told apart.
+    inline bool prefers(complexity a, complexity b, const std::vector<double> & n, const std::vector<double> & t,
+                        double margin = 2.0, double floor = 0.05) {
+        return std::max(fit(b, n, t).rms, floor) >= margin * std::max(fit(a, n, t).rms, floor);
+    }
+}
+}
+#endif // MBM_STATS_HPP_
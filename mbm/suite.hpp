@@ -29,6 +29,20 @@
 #define MBM_SUITE_HPP_
 
 #include "measure.hpp"
+#include "counters.hpp"
+#include "allocs.hpp"
+#include "cache.hpp"
+#include "environment.hpp"
+#include "interference.hpp"
+#include "params.hpp"
+#include "types.hpp"
+#include "dataset.hpp"
+#include "histogram.hpp"
+#include "stats.hpp"
+#include "threads.hpp"
+#include "pipe.hpp"
+#include "baseline.hpp"
+#include "reporter.hpp"
 #include "opt.hpp"
 
 #include <boost/assert.hpp>
@@ -38,6 +52,8 @@
 #include <boost/lexical_cast.hpp>
 
 #include <string>
+#include <iostream>
+#include <fstream>
 #include <cstring>
 #include <cmath>
 #include <regex>
@@ -45,17 +61,27 @@
 #include <cstdint>
 #include <sched.h>
 #include <unistd.h>
+#include <sys/wait.h>
 #include <functional>
+#include <future>
+#include <atomic>
+#include <exception>
+#include <memory>
 #include <map>
 #include <set>
 #include <vector>
 #include <limits>
 #include <algorithm>
 #include <iterator>
+#include <numeric>
+#include <random>
 #include <initializer_list>
+#include <tuple>
 
 namespace mbm {
     struct fixture {
+        virtual ~fixture() { }
+
         virtual void setup() { }
         virtual void setup(const boost::any&) { }
         virtual void teardown() { }
@@ -63,35 +89,332 @@ namespace mbm {
         virtual void fixture_setup() { }
         virtual void fixture_teardown() { }
 
+        // Memory go() reads, flushed before each --cache=cold run. With no
+        // ranges the whole last level cache is swept instead.
+        virtual void cold_ranges(std::vector<mem_range> & ranges) { }
+
         template<typename T>
         void result(T && t) {
             asm volatile("" : "+r" (t));
         }
 
         virtual void go() = 0;
+
+        // --batch calls go() repeatedly after one setup(), so every call must
+        // see the same state. A fixture whose go() changes what it measures,
+        // such as sorting its own input, returns false to time one call per
+        // run.
+        virtual bool batchable() const { return true; }
+
+        // Work done by one call of go(), for per item and per byte rates. Read
+        // after setup(), so a table fixture can derive it from its row; 0
+        // reports times per call only.
+        virtual double items() const { return 0.0; }
+        virtual double bytes() const { return 0.0; }
+
+        // Cycles of batch calls of go(), one virtual call each
+        virtual uint64_t time_go(timer::kind timer, unsigned batch) {
+            return timer::time_loop(timer, batch, [this] { go(); });
+        }
+    };
+
+    // A fixture whose go() may run concurrently on the threads of a
+    // --threads sweep, thread is the index of the calling thread
+    struct threaded_fixture : fixture {
+        virtual void go(unsigned thread) = 0;
+        virtual void go() { go(0); }
     };
 
     namespace detail {
+        struct inlined_tag { };
+    }
+
+    // A fixture whose go() is called non virtually from a timing loop
+    // instantiated for Derived, so it is inlined into the loop. Derived
+    // defines go() and the rest of the Base interface as usual.
+    template<typename Derived, typename Base = fixture>
+    struct inline_fixture : Base, detail::inlined_tag {
+        virtual uint64_t time_go(timer::kind timer, unsigned batch) {
+            auto self = static_cast<Derived*>(this);
+            return timer::time_loop(timer, batch, [self] { self->Derived::go(); });
+        }
+    };
+
+    // Runs a lambda (or any callable) as an inline_fixture, keeping its
+    // result if it has one
+    template<typename F>
+    struct lambda_fixture : inline_fixture<lambda_fixture<F>> {
+        F body;
+
+        explicit lambda_fixture(F body) : body(std::move(body)) { }
+
+        virtual void go() { call(std::is_void<decltype(body())>()); }
+
+        void call(std::true_type) { body(); }
+        void call(std::false_type) { this->result(body()); }
+    };
+
+    // Factory of a lambda_fixture, for registering a lambda as a fixture
+    template<typename F>
+    std::function<fixture*(void)> inlined(F body) {
+        return [body] { return new lambda_fixture<F>(body); };
+    }
+
+    // A table fixture taking its row parameter as a Param rather than a
+    // boost::any. Registered by a factory returning the derived fixture, a
+    // generator or list whose values do not convert to Param fails to
+    // compile. Through a factory returning fixture* the rows arrive as
+    // boost::any and must hold exactly a Param.
+    template<typename Param>
+    struct table_fixture : fixture {
+        typedef Param param_type;
+
+        using fixture::setup;
+        virtual void setup(const Param &) { }
+
+        virtual void setup(const boost::any & v) {
+            auto p = boost::any_cast<Param>(&v);
+            if (!p) 
+                throw std::runtime_error("table value of type " + detail::demangle(v.type().name()) + 
+                                         " does not match parameter type " + type_name<Param>::get());
+            setup(*p);
+        }
+    };
+
+    namespace detail {
+        // The parameter of a table row, set on the fixture before each run
+        struct row_param {
+            virtual ~row_param() { }
+            virtual void setup(fixture & f) const = 0;
+        };
+
+        struct no_param : row_param {
+            virtual void setup(fixture & f) const { f.setup(); }
+        };
+
+        struct any_param : row_param {
+            explicit any_param(boost::any value) : value(std::move(value)) { }
+            virtual void setup(fixture & f) const { f.setup(value); }
+
+            boost::any value;
+        };
+
+        // Only bound to fixtures made by a factory returning a table_fixture<P>
+        template<typename P>
+        struct typed_param : row_param {
+            explicit typed_param(P value) : value(std::move(value)) { }
+            virtual void setup(fixture & f) const { static_cast<table_fixture<P>&>(f).setup(value); }
+
+            P value;
+        };
+
+        template<typename P> struct param_tag { };
+
+        template<typename T> struct void_type { typedef void type; };
+
+        // The Param of the table_fixture a factory F returns, if it does
+
+        template<typename F, typename = void>
+        struct table_param { };
+
+        template<typename F>
+        struct table_param<F, typename void_type<typename std::remove_pointer<decltype(std::declval<F&>()())>::type::param_type>::type> {
+            typedef typename std::remove_pointer<decltype(std::declval<F&>()())>::type fixture_type;
+            typedef typename fixture_type::param_type type;
+            static_assert(std::is_base_of<table_fixture<type>, fixture_type>::value, "param_type is reserved for table_fixture");
+        };
+
+        template<typename F, typename = void>
+        struct is_table_factory : std::false_type { };
+
+        template<typename F>
+        struct is_table_factory<F, typename void_type<typename table_param<F>::type>::type> : std::true_type { };
+    }
+
+    namespace detail {
+        // Sampling stops once the confidence interval of the estimator is
+        // within precision, or on hitting max_runs or the time budget
+        struct adaptive_opts {
+            double precision;  // relative CI half width, 0 for a fixed numruns
+            stats::estimator estimator;
+            unsigned min_runs;
+            unsigned max_runs;
+            double budget;     // seconds per fixture or table row
+
+            adaptive_opts() : precision(0.0), estimator(stats::median), min_runs(16), max_runs(1000000), budget(10.0) { }
+        };
+
+        // Runs discarded before measurement until two consecutive windows of
+        // window runs have medians within tolerance of each other
+        struct warmup_opts {
+            unsigned max_runs;  // 0 disables warmup
+            unsigned window;
+            double tolerance;
+            double budget;      // seconds per fixture or table row
+
+            warmup_opts() : max_runs(0), window(16), tolerance(0.02), budget(1.0) { }
+        };
+
+        struct run_opts {
+            unsigned numruns;
+            timer::kind timer_kind;
+            uint64_t batch_cycles;  // 0 times a single go() per run
+            counter_group * counters;
+            alloc_tracker * allocs;     // allocations and page faults of the timed region, or nullptr
+            const cache_evictor * evict;  // cold runs, nullptr keeps the caches warm
+            interference_monitor * interference;  // marks runs that were interfered with, or nullptr
+            bool rerun;                 // runs again those that were
+            uint64_t overhead;
+            adaptive_opts adaptive;
+            warmup_opts warmup;
+            unsigned histogram_digits;  // 0 keeps every sample
+            unsigned threads;           // threaded_fixture only, 0 runs go() on the calling thread
+            std::vector<unsigned> cpus; // the threads are pinned to in turn
+
+            run_opts(unsigned numruns, timer::kind timer_kind, uint64_t batch_cycles = 0, counter_group * counters = nullptr) :
+                numruns(numruns), timer_kind(timer_kind), batch_cycles(batch_cycles), counters(counters), allocs(nullptr), evict(nullptr), interference(nullptr), rerun(false), 
+                overhead(0), 
+                histogram_digits(0), threads(0) { }
+        };
+
+        struct run_res_t {
+            enum stop_t { fixed, converged, max_runs, budget };
+
+            std::vector<uint64_t> samples;  // raw cycles for batch calls of go(), a uniform subset with a histogram
+            histogram hist;                 // every run net of the overhead, when enabled
+            std::vector<uint64_t> warmup;   // discarded runs, same units as samples
+            bool steady;                    // warmup ended on the steady state test
+            unsigned batch;
+            double elements;  // numeric table parameter, 0 if not applicable
+            std::vector<param_value> params;  // labeled dimensions of the table parameter
+            counter_totals counters;
+            alloc_totals allocs;
+            interference_totals interference;
+            stop_t stop;
+            double precision;  // achieved relative CI half width, adaptive runs only
+            unsigned threads;               // 0 unless run on a thread team
+            std::vector<uint64_t> rounds;   // wall cycles from the first start to the last stop of each round
+            bool cold;                      // caches evicted before each run
+            double items;                   // work per call the fixture declared
+            double bytes;
+
+            run_res_t() : steady(false), batch(1), elements(0.0), stop(fixed), precision(0.0), threads(0), cold(false),
+                items(0.0), bytes(0.0) { }
+
+            size_t runs() const { return hist.enabled() ? hist.count() : samples.size(); }
+
+            // Per call cycles, net of the timing overhead
+            std::vector<double> per_call(uint64_t overhead) const { return per_call(samples, overhead); }
+
+            std::vector<double> per_call(const std::vector<uint64_t> & runs, uint64_t overhead) const {
+                std::vector<double> res;
+                res.reserve(runs.size());
+                double n = batch;
+                std::transform(std::begin(runs), std::end(runs), std::inserter(res, std::begin(res)), 
+                        [overhead, n](uint64_t t) { return t > overhead ? (t - overhead) / n : 0.0; });
+                return res;
+            }
+
+            const char * stop_reason() const {
+                static const char * reasons[] = { "fixed", "converged", "max runs", "budget" };
+                return reasons[stop];
+            }
+
+            template<typename Out>
+            void write(Out & out) const {
+                out.put(samples);
+                hist.write(out);
+                out.put(warmup);
+                out.put(steady);
+                out.put(batch);
+                out.put(elements);
+                out.template put<uint64_t>(params.size());
+                for (const auto & p : params) {
+                    out.put(p.label);
+                    out.put(p.value);
+                    out.put(p.number);
+                }
+                out.put(counters);
+                out.put(allocs);
+                out.put(interference);
+                out.put(stop);
+                out.put(precision);
+                out.put(threads);
+                out.put(rounds);
+                out.put(cold);
+                out.put(items);
+                out.put(bytes);
+            }
+
+            template<typename In>
+            void read(In & in) {
+                in.get(samples);
+                hist.read(in);
+                in.get(warmup);
+                in.get(steady);
+                in.get(batch);
+                in.get(elements);
+                params.resize(in.template get<uint64_t>());
+                for (auto & p : params) {
+                    in.get(p.label);
+                    in.get(p.value);
+                    in.get(p.number);
+                }
+                in.get(counters);
+                in.get(allocs);
+                in.get(interference);
+                in.get(stop);
+                in.get(precision);
+                in.get(threads);
+                in.get(rounds);
+                in.get(cold);
+                in.get(items);
+                in.get(bytes);
+            }
+        };
+
         struct fixture_runner {
-            typedef std::vector<uint64_t> run_res_t;
+            typedef detail::run_res_t run_res_t;
             typedef std::vector<std::pair<std::string, run_res_t>> run_table_t;
 
-            explicit fixture_runner(const std::string & group, bool use_rdtsc, std::function<fixture*(void)> factory) : 
+            explicit fixture_runner(const std::string & group, std::function<fixture*(void)> factory) : 
                 group_(group),
-                use_rdtsc_(use_rdtsc), 
+                order_(0),
+                tolerance_(-1.0),
                 factory_(std::move(factory)) { } 
 
             template<typename T>
-            explicit fixture_runner(const std::string & group, bool use_rdtsc, std::function<fixture*(void)> factory, std::initializer_list<T> table_data) :
+            explicit fixture_runner(const std::string & group, std::function<fixture*(void)> factory, std::initializer_list<T> table_data) :
+                group_(group),
+                order_(0),
+                tolerance_(-1.0),
+                factory_(std::move(factory)),
+                generator_(new generator_model<value_list<T>>(values(table_data))) { }
+
+            template<typename G>
+            explicit fixture_runner(const std::string & group, std::function<fixture*(void)> factory, G gen,
+                                    typename std::enable_if<is_generator<G>::value>::type * = nullptr) :
+                group_(group),
+                order_(0),
+                tolerance_(-1.0),
+                factory_(std::move(factory)),
+                generator_(new generator_model<G>(std::move(gen))) { }
+
+            // Rows passed by value to the setup(const P&) of a table_fixture<P>
+            template<typename P, typename G>
+            explicit fixture_runner(const std::string & group, std::function<fixture*(void)> factory, G gen, param_tag<P>) :
                 group_(group),
-                use_rdtsc_(use_rdtsc),
+                order_(0),
+                tolerance_(-1.0),
                 factory_(std::move(factory)),
-                generator_(new model<T>(std::move(table_data))) { }
+                generator_(new generator_model<G, P>(std::move(gen))) { }
 
             fixture_runner(const fixture_runner & other) :
                 group_(other.group_),
-                use_rdtsc_(other.use_rdtsc_), 
-                factory_(other.factory_) {
+                order_(other.order_),
+                tolerance_(other.tolerance_),
+                factory_(other.factory_),
+                datasets_(other.datasets_) {
                     if (other.generator_)
                         generator_.reset(other.generator_->clone());
                 }
@@ -100,8 +423,10 @@ namespace mbm {
 
             fixture_runner & operator=(const fixture_runner & rhs) {
                 group_ = rhs.group_;
-                use_rdtsc_ = rhs.use_rdtsc_;
+                order_ = rhs.order_;
+                tolerance_ = rhs.tolerance_;
                 factory_ = rhs.factory_;
+                datasets_ = rhs.datasets_;
                 if (rhs.generator_)
                     generator_.reset(rhs.generator_->clone());
                 return *this;
@@ -110,10 +435,6 @@ namespace mbm {
             std::unique_ptr<fixture> setup() const {
                 std::unique_ptr<fixture> res(factory_());
                 res->fixture_setup();
-                if (use_rdtsc_)
-                    dummy_read_tsc(std::true_type());
-                else
-                    dummy_read_tsc(std::false_type());
                 return res;
             }
 
@@ -122,117 +443,594 @@ namespace mbm {
             }
 
             std::string group() const { return group_; }
+            size_t order() const { return order_; }
+            void order(size_t order) { order_ = order; }
+            double tolerance() const { return tolerance_; }
+            void tolerance(double tolerance) { tolerance_ = tolerance; }
             bool is_table() const { return generator_.get() != nullptr; }
+            const dataset_slots_t & datasets() const { return datasets_; }
+            void datasets(const dataset_slots_t & datasets) { datasets_ = datasets; }
 
-            run_table_t run_table(unsigned numruns, std::unique_ptr<fixture> & fixture) const {
+            run_table_t run_table(const run_opts & opts, std::unique_ptr<fixture> & fixture) const {
                 BOOST_ASSERT(is_table());
                 run_table_t res;
                 res.reserve(generator_->size());
-                std::generate_n(std::inserter(res, std::begin(res)), generator_->size(),
-                        [&] { 
-                            auto v = generator_->next();
-                            return std::make_pair(generator_->to_string(v), run(numruns, fixture, v));
-                        });
+                for (size_t i = 0; i < generator_->size(); i++) {
+                    auto row = generator_->row(i);
+                    auto r = run(opts, fixture, *row.param);
+                    r.elements = row.elements;
+                    r.params = std::move(row.params);
+                    res.emplace_back(std::move(row.name), std::move(r));
+                }
                 return res;
             }
 
-            run_res_t run(unsigned numruns, std::unique_ptr<fixture> & fixture, boost::any v = boost::any()) const {
+            run_res_t run(const run_opts & opts, std::unique_ptr<fixture> & fixture, const row_param & v = no_param()) const {
+                if (opts.threads) return run_threaded(opts, fixture, v);
+                switch (opts.timer_kind) {
+                    case timer::cpuid_kind: return run<timer::cpuid>(opts, fixture, v);
+                    case timer::cpuid_rdtscp_kind: return run<timer::cpuid_rdtscp>(opts, fixture, v);
+                    case timer::lfence_kind: return run<timer::lfence>(opts, fixture, v);
+                    case timer::rdtscp_kind: return run<timer::rdtscp>(opts, fixture, v);
+                    default: return run<timer::clock>(opts, fixture, v);
+                }
+            }
+
+            template<typename Timer>
+            run_res_t run(const run_opts & opts, std::unique_ptr<fixture> & fixture, const row_param & v) const {
+                dummy_read<Timer>();
                 run_res_t res; 
-                res.reserve(numruns);
-                std::generate_n(std::inserter(res, std::begin(res)), numruns, [&] { return go(fixture, v); });
+                res.batch = calibrate_batch<Timer>(opts.batch_cycles, fixture, v);
+                warmup<Timer>(opts.warmup, opts.evict, fixture, v, res);
+                recorder rec(opts, res);
+                if (opts.adaptive.precision > 0.0) {
+                    run_adaptive<Timer>(opts, fixture, v, res, rec);
+                    rec.finish();
+                    return res;
+                }
+                res.samples.reserve(std::min<size_t>(opts.numruns, size_t(recorder::reservoir)));
+                for (auto i = 0u; i < opts.numruns; i++)
+                    rec(timed_run<Timer>(opts, fixture, v, res));
+                rec.finish();
                 return res;
             }
 
+            // Keeps every run as a sample or, with a histogram, records every
+            // run in the histogram and keeps a uniform reservoir of samples
+            // for comparisons and baselines. Runs the interference monitor
+            // saw interfered with are left out, unless no run was clean. The
+            // histogram is sized up front for runs up to headroom times the
+            // longest warmup run, or else the first run, so it only
+            // allocates between timed runs on an outlier beyond that.
+            struct recorder {
+                static const size_t reservoir = 10000;
+                static const uint64_t headroom = 4;
+
+                run_res_t & res;
+                uint64_t overhead;
+                const interference_monitor * monitor;
+                std::vector<uint64_t> marked;
+                std::mt19937_64 rng;
+
+                recorder(const run_opts & opts, run_res_t & res) : 
+                    res(res), overhead(opts.overhead), monitor(opts.interference), rng(0x6d626d) { 
+                    if (opts.histogram_digits) res.hist = histogram(opts.histogram_digits);
+                    if (!res.warmup.empty()) 
+                        res.hist.reserve(headroom * *std::max_element(std::begin(res.warmup), std::end(res.warmup)));
+                }
+
+                void operator()(uint64_t t) {
+                    if (monitor && !monitor->clean()) {
+                        res.interference.excluded++;
+                        if (marked.size() < reservoir) marked.push_back(t);
+                        return;
+                    }
+                    record(t);
+                }
+
+                void finish() {
+                    if (res.runs() || marked.empty()) return;
+                    res.interference.excluded = 0;
+                    for (auto t : marked) record(t);
+                }
+
+                void record(uint64_t t) {
+                    if (!res.hist.enabled()) {
+                        res.samples.push_back(t);
+                        return;
+                    }
+                    if (!res.hist.count()) res.hist.reserve(headroom * t);
+                    res.hist.record(t > overhead ? t - overhead : 0);
+                    if (res.samples.size() < reservoir) {
+                        res.samples.push_back(t);
+                        return;
+                    }
+                    auto i = std::uniform_int_distribution<uint64_t>(0, res.hist.count() - 1)(rng);
+                    if (i < reservoir) res.samples[i] = t;
+                }
+            };
+
         private:
+            // A table as rows, each a parameter bound to the way the fixture
+            // takes it and its name, elements and labeled dimensions
+            struct table_row {
+                std::unique_ptr<row_param> param;
+                std::string name;
+                double elements;
+                std::vector<param_value> params;
+            };
+
             struct concept {
                 virtual ~concept() { }
 
                 virtual concept* clone() const = 0;
                 virtual size_t size() const = 0;
-                virtual std::string to_string(const boost::any &) const = 0;
-                virtual boost::any next() = 0;
+                virtual table_row row(size_t i) const = 0;
             };
 
-            template<typename T> 
-            struct model : concept {
-                typedef std::initializer_list<T> list_t;
-                model(list_t t) : 
-                    data(std::move(t)),
-                    cur(std::begin(data)) { }
+            // Values are computed as they are reached. The row name is
+            // label=value for labeled dimensions, comma separated. P is the
+            // parameter type of a table_fixture, void passes a boost::any.
+            template<typename G, typename P = void>
+            struct generator_model : concept {
+                typedef typename G::value_type value_type;
+
+                explicit generator_model(G gen) : gen(std::move(gen)) { }
+
+                virtual concept* clone() const { return new generator_model<G, P>(*this); }
+                virtual size_t size() const { return gen.size(); }
+
+                virtual table_row row(size_t i) const {
+                    auto v = gen[i];
+                    table_row res;
+                    res.elements = gen.number(v);
+                    for (const auto & p : label_values(v)) {
+                        res.name += (res.name.empty() ? "" : ",") + (p.label.empty() ? p.value : p.label + "=" + p.value);
+                        if (!p.label.empty()) res.params.push_back(p);
+                    }
+                    res.param = bind(std::move(v), std::is_void<P>());
+                    return res;
+                }
 
-                virtual concept* clone() const { return new model<T>(*this); }
-                virtual size_t size() const { return data.size(); }
-                virtual std::string to_string(const boost::any & v) const {
-                    BOOST_ASSERT(!v.empty());
-                    auto vv = boost::any_cast<T>(v);
-                    return boost::lexical_cast<std::string>(vv);
+                std::vector<param_value> label_values(const value_type & v) const {
+                    std::vector<std::string> values;
+                    gen.strings(v, values);
+                    auto labels = gen.labels();
+                    auto numeric = gen.numeric();
+                    std::vector<param_value> res;
+                    for (size_t i = 0; i < values.size(); i++) res.push_back(param_value { labels[i], values[i], numeric[i] });
+                    return res;
                 }
 
-                virtual boost::any next() { return cur != std::end(data) ? boost::any(*cur++) : boost::any(); }
+                static std::unique_ptr<row_param> bind(value_type v, std::true_type) {
+                    return std::unique_ptr<row_param>(new any_param(boost::any(std::move(v))));
+                }
 
-                list_t data;
-                typename list_t::iterator cur;
+                static std::unique_ptr<row_param> bind(value_type v, std::false_type) {
+                    return std::unique_ptr<row_param>(new typed_param<P>(std::move(v)));
+                }
+
+                G gen;
             };
 
-            uint64_t go(std::unique_ptr<fixture> & fixture, boost::any v) const {
-                if (v.empty())
-                    fixture->setup();
-                else
-                    fixture->setup(v);
+            template<typename Timer>
+            void warmup(const warmup_opts & wo, const cache_evictor * evict, std::unique_ptr<fixture> & fixture, 
+                        const row_param & v, run_res_t & res) const {
+                if (!wo.max_runs) return;
+                auto deadline = detail::monotonic_raw_ns() + static_cast<uint64_t>(wo.budget * 1e9);
+                while (res.warmup.size() < wo.max_runs) {
+                    res.warmup.push_back(go<Timer>(fixture, v, res.batch, evict));
+                    if (is_steady(res.warmup, wo.window, wo.tolerance)) {
+                        res.steady = true;
+                        break;
+                    }
+                    if (detail::monotonic_raw_ns() >= deadline) break;
+                }
+            }
+
+            static bool is_steady(const std::vector<uint64_t> & runs, size_t window, double tolerance) {
+                if (!window || runs.size() < 2 * window) return false;
+                auto median = [window](std::vector<uint64_t>::const_iterator it) {
+                    std::vector<uint64_t> w(it, it + window);
+                    std::nth_element(std::begin(w), std::begin(w) + window / 2, std::end(w));
+                    return static_cast<double>(w[window / 2]);
+                };
+                auto prev = median(std::end(runs) - 2 * window);
+                auto cur = median(std::end(runs) - window);
+                return std::fabs(cur - prev) <= tolerance * cur;
+            }
 
-                BOOST_SCOPE_EXIT(&fixture) {
+            // The interval is rechecked after each ~25% growth in samples so
+            // the sorting cost stays linearithmic overall
+            template<typename Timer>
+            void run_adaptive(const run_opts & opts, std::unique_ptr<fixture> & fixture, const row_param & v,
+                              run_res_t & res, recorder & rec) const {
+                const auto & ad = opts.adaptive;
+                auto deadline = detail::monotonic_raw_ns() + static_cast<uint64_t>(ad.budget * 1e9);
+                size_t next_check = std::max(ad.min_runs, 2u);
+                res.samples.reserve(std::min(next_check, size_t(recorder::reservoir)));
+                for (;;) {
+                    auto expired = false;
+                    while (res.runs() < next_check && !expired) {
+                        rec(timed_run<Timer>(opts, fixture, v, res));
+                        expired = detail::monotonic_raw_ns() >= deadline;
+                    }
+
+                    res.precision = res.hist.enabled() ? stats::relative_ci(res.hist, ad.estimator) 
+                        : stats::relative_ci(res.per_call(opts.overhead), ad.estimator);
+                    if (res.precision <= ad.precision && res.runs() >= ad.min_runs) {
+                        res.stop = run_res_t::converged;
+                        break;
+                    } 
+                    if (res.runs() >= ad.max_runs) {
+                        res.stop = run_res_t::max_runs;
+                        break;
+                    }
+                    if (expired) {
+                        res.stop = run_res_t::budget;
+                        break;
+                    }
+                    next_check = std::min<size_t>(ad.max_runs, std::max(next_check + 8, next_check * 5 / 4));
+                }
+            }
+
+            static const unsigned max_batch = 1u << 20;
+
+            // Grow the number of go() calls per timed run until a run covers
+            // at least target cycles
+            template<typename Timer>
+            unsigned calibrate_batch(uint64_t target, std::unique_ptr<fixture> & fixture, const row_param & v) const {
+                unsigned batch = 1;
+                while (target && batch < max_batch && fixture->batchable()) {
+                    uint64_t elapsed = std::numeric_limits<uint64_t>::max();
+                    for (auto i = 0; i < 3; i++)
+                        elapsed = std::min(elapsed, go<Timer>(fixture, v, batch, nullptr));
+                    if (elapsed >= target) break;
+                    auto scaled = static_cast<double>(batch) * target / std::max<uint64_t>(elapsed, 1);
+                    batch = static_cast<unsigned>(std::min<double>(max_batch, std::max(2.0 * batch, scaled)));
+                }
+                return batch;
+            }
+
+            static const unsigned max_reruns = 10;
+
+            // A run for the samples, run again up to max_reruns times while
+            // it was interfered with and opts.rerun is set
+            template<typename Timer>
+            uint64_t timed_run(const run_opts & opts, std::unique_ptr<fixture> & fixture, const row_param & v,
+                               run_res_t & res) const {
+                for (auto attempt = 0u; ; attempt++) {
+                    auto t = go<Timer>(fixture, v, res.batch, opts.evict, &opts, &res);
+                    if (!opts.interference || !opts.rerun || opts.interference->clean() || attempt == max_reruns) 
+                        return t;
+                    res.interference.reruns++;
+                }
+            }
+
+            // The counters, allocation tracker and interference monitor of
+            // opts are only used for timed runs, which pass the result to add to
+            template<typename Timer>
+            uint64_t go(std::unique_ptr<fixture> & fixture, const row_param & v, unsigned batch,
+                        const cache_evictor * evict, const run_opts * opts = nullptr, run_res_t * res = nullptr) const {
+                auto counters = res ? opts->counters : nullptr;
+                auto allocs = res ? opts->allocs : nullptr;
+                auto monitor = res ? opts->interference : nullptr;
+                v.setup(*fixture);
+                if (res) declared_work(*fixture, *res);
+
+                BOOST_SCOPE_EXIT_TPL(&fixture) {
                     fixture->teardown();
                 } BOOST_SCOPE_EXIT_END
-                return use_rdtsc_ ? go(fixture, std::true_type()) : go(fixture, std::false_type());
+
+                if (evict) evict_caches(*evict, fixture);
+                if (allocs) allocs->start();
+                if (monitor) monitor->start();  // outside the counters, which would see its reads
+                if (counters) counters->start();
+                auto t = fixture->time_go(timer::kind_of<Timer>::value, batch);
+                if (counters) counters->stop(res->counters);
+                if (monitor) monitor->stop(res->interference);
+                if (allocs) allocs->stop(res->allocs);
+                return t;
             }
 
-            template<typename T>
-            uint64_t go(std::unique_ptr<fixture> & fixture, T t) const {
-                auto t0 = read_initial_tsc(); 
-                fixture->go();
-                auto t1 = read_final_tsc(t);
-                return t1 - t0;
+            static void declared_work(const fixture & f, run_res_t & res) {
+                res.items = f.items();
+                res.bytes = f.bytes();
             }
 
-            template<typename T>
-            void dummy_read_tsc(T t) const {
-                read_initial_tsc();
-                read_final_tsc(t);
-                read_final_tsc(t);
-                read_final_tsc(t);
+            run_res_t run_threaded(const run_opts & opts, std::unique_ptr<fixture> & fixture, const row_param & v) const {
+                switch (opts.timer_kind) {
+                    case timer::cpuid_kind: return run_threaded<timer::cpuid>(opts, fixture, v);
+                    case timer::cpuid_rdtscp_kind: return run_threaded<timer::cpuid_rdtscp>(opts, fixture, v);
+                    case timer::lfence_kind: return run_threaded<timer::lfence>(opts, fixture, v);
+                    case timer::rdtscp_kind: return run_threaded<timer::rdtscp>(opts, fixture, v);
+                    default: return run_threaded<timer::clock>(opts, fixture, v);
+                }
+            }
+
+            // Each round the calling thread sets the fixture up, releases the
+            // team to time batch calls of go(thread) each, and tears it down
+            // once all have stopped. Threads only write their own slots, the
+            // barriers order those writes before they are read. If setup or
+            // teardown throws, the team is released with cancel set so it
+            // can be joined. A thread whose go() throws keeps the exception,
+            // sets failed and still meets the done barrier; the team is then
+            // cancelled and the exception rethrown here once it has joined.
+            template<typename Timer>
+            run_res_t run_threaded(const run_opts & opts, std::unique_ptr<fixture> & fixture, const row_param & v) const {
+                auto tf = dynamic_cast<threaded_fixture*>(fixture.get());
+                BOOST_ASSERT(tf);
+                dummy_read<Timer>();
+                run_res_t res;
+                res.threads = opts.threads;
+                res.batch = calibrate_batch<Timer>(opts.batch_cycles, fixture, v);
+
+                std::vector<run_res_t> per_thread(opts.threads);
+                std::vector<std::pair<uint64_t, uint64_t>> spans(opts.threads);
+                spin_barrier start(opts.threads + 1), done(opts.threads + 1);
+                std::atomic<bool> cancel(false), failed(false);
+                std::vector<std::exception_ptr> errors(opts.threads);
+                auto batch = res.batch;
+                {
+                    thread_team team(opts.threads, opts.cpus, [&](unsigned thread) {
+                                recorder rec(opts, per_thread[thread]);
+                                dummy_read<Timer>();
+                                for (auto r = 0u; r < opts.numruns; r++) {
+                                    start.wait();
+                                    if (cancel.load(std::memory_order_acquire)) return;
+                                    try {
+                                        auto t0 = Timer::start();
+                                        for (auto i = 0u; i < batch; i++)
+                                            tf->go(thread);
+                                        auto t1 = Timer::stop();
+                                        spans[thread] = std::make_pair(t0, t1);
+                                        rec(t1 - t0);
+                                    } catch (...) {
+                                        errors[thread] = std::current_exception();
+                                        failed.store(true, std::memory_order_relaxed);
+                                    }
+                                    done.wait();
+                                }
+                            });
+
+                    res.rounds.reserve(opts.numruns);
+                    auto release = [&] {
+                        cancel.store(true, std::memory_order_release);
+                        start.wait();
+                    };
+                    for (auto r = 0u; r < opts.numruns; r++) {
+                        try {
+                            v.setup(*fixture);
+                            declared_work(*fixture, res);
+                            if (opts.evict) evict_caches(*opts.evict, fixture);
+                        } catch (...) {
+                            release();
+                            throw;
+                        }
+                        start.wait();
+                        done.wait();
+                        try {
+                            fixture->teardown();
+                        } catch (...) {
+                            if (r + 1 < opts.numruns) release();
+                            throw;
+                        }
+                        if (failed.load(std::memory_order_relaxed)) {
+                            if (r + 1 < opts.numruns) release();
+                            break;
+                        }
+                        auto first = std::min_element(std::begin(spans), std::end(spans))->first;
+                        auto last = std::max_element(std::begin(spans), std::end(spans), 
+                                [](const std::pair<uint64_t, uint64_t> & a, const std::pair<uint64_t, uint64_t> & b) { 
+                                    return a.second < b.second; 
+                                })->second;
+                        res.rounds.push_back(last - first);
+                    }
+                }
+                for (const auto & e : errors)
+                    if (e) std::rethrow_exception(e);
+
+                for (auto & t : per_thread) {
+                    res.hist.merge(t.hist);
+                    res.samples.insert(std::end(res.samples), std::begin(t.samples), std::end(t.samples));
+                }
+                return res;
+            }
+
+            static void evict_caches(const cache_evictor & evict, std::unique_ptr<fixture> & fixture) {
+                std::vector<mem_range> ranges;
+                fixture->cold_ranges(ranges);
+                evict.evict(ranges);
+            }
+
+            template<typename Timer>
+            void dummy_read() const {
+                Timer::start();
+                Timer::stop();
+                Timer::stop();
+                Timer::stop();
             }
 
             std::string group_;
-            bool use_rdtsc_;
+            size_t order_;  // registration order, the default comparison baseline is the first in its group
+            double tolerance_;  // relative slowdown allowed against a saved baseline, < 0 uses --tolerance
             std::function<fixture*(void)> factory_;
+            dataset_slots_t datasets_;  // held until the last fixture using them has run
             std::unique_ptr<concept> generator_;
         };
 
+        struct no_table { };
+
+        template<typename... Args>
+        struct is_table : std::false_type { };
+
+        template<typename A, typename... Args>
+        struct is_table<A, Args...> : std::integral_constant<bool, is_generator<A>::value || std::is_same<A, no_table>::value> { };
+
+        template<typename T, typename... Args>
+        struct is_table<std::initializer_list<T>, Args...> : std::true_type { };
+
+        // A factory of T from a copy of the constructor arguments, wrap
+        // references in std::ref or std::cref
+        template<typename T, typename... Args>
+        struct constructor {
+            std::tuple<Args...> args;
+
+            T * operator()() const { return make(typename make_indices<sizeof...(Args)>::type()); }
+
+            template<size_t... I>
+            T * make(indices<I...>) const { return new T(std::get<I>(args)...); }
+        };
+
         struct easy_init {
             typedef std::map<std::string, fixture_runner> fixture_map_t;
             fixture_map_t & fixtures;
-            bool use_rdtsc;
             std::string group;
+            dataset_slots_t datasets;
+
+            easy_init(fixture_map_t & fixtures, const std::string & group) : 
+                fixtures(fixtures), group(group) { }
 
-            easy_init(fixture_map_t & fixtures, bool use_rdtsc, const std::string & group) : 
-                fixtures(fixtures), use_rdtsc(use_rdtsc), group(group) { }
+            template<template<typename...> class F, typename G, typename... Args>
+            struct each_combination;
 
             easy_init & operator()(const std::string & name, std::function<fixture*(void)> factory) { 
-                fixtures[name] = fixture_runner(group, use_rdtsc, std::move(factory));
-                return *this;
+                return add(name, fixture_runner(group, std::move(factory)));
             }
 
             template<typename T>
             easy_init & operator()(const std::string & name, std::function<fixture*(void)> factory, std::initializer_list<T> table_data) { 
-                fixtures[name] = fixture_runner(group, use_rdtsc, std::move(factory), std::move(table_data));
+                return add(name, fixture_runner(group, std::move(factory), std::move(table_data)));
+            }
+
+            // As above, with the slowdown allowed against a saved baseline
+            // before --compare reports a regression (e.g. 0.1 for 10%)
+            easy_init & operator()(const std::string & name, std::function<fixture*(void)> factory, double tolerance) { 
+                return add(name, fixture_runner(group, std::move(factory)), tolerance);
+            }
+
+            template<typename T>
+            easy_init & operator()(const std::string & name, std::function<fixture*(void)> factory, std::initializer_list<T> table_data,
+                                   double tolerance) { 
+                return add(name, fixture_runner(group, std::move(factory), std::move(table_data)), tolerance);
+            }
+
+            // Rows from a generator, see params.hpp
+            template<typename G>
+            typename std::enable_if<is_generator<G>::value, easy_init &>::type
+            operator()(const std::string & name, std::function<fixture*(void)> factory, G gen, double tolerance = -1.0) { 
+                return add(name, fixture_runner(group, std::move(factory), std::move(gen)), tolerance);
+            }
+
+            // A factory of table_fixture<P> gets each row as a P, bound here
+            template<typename F, typename G>
+            typename std::enable_if<is_table_factory<F>::value && is_generator<G>::value, easy_init &>::type
+            operator()(const std::string & name, F factory, G gen, double tolerance = -1.0) { 
+                typedef typename table_param<F>::type P;
+                static_assert(std::is_convertible<typename G::value_type, P>::value, 
+                              "table values do not convert to the parameter type of the fixture");
+                return add(name, fixture_runner(group, std::function<fixture*(void)>(std::move(factory)), std::move(gen), 
+                                                param_tag<P>()), tolerance);
+            }
+
+            template<typename F, typename T>
+            typename std::enable_if<is_table_factory<F>::value, easy_init &>::type
+            operator()(const std::string & name, F factory, std::initializer_list<T> table_data, double tolerance = -1.0) { 
+                return (*this)(name, std::move(factory), values(table_data), tolerance);
+            }
+
+            // F<T...> for every combination of one type from each of the
+            // typelists, named name<T,...> and constructed from args. The
+            // instantiations are registered as if one by one.
+            template<template<typename...> class F, typename... Lists, typename... Args>
+            typename std::enable_if<!is_table<Args...>::value, easy_init &>::type
+            each(const std::string & name, Args... args) {
+                return each<F, Lists...>(name, no_table(), std::move(args)...);
+            }
+
+            template<template<typename...> class F, typename... Lists, typename T, typename... Args>
+            easy_init & each(const std::string & name, std::initializer_list<T> table_data, Args... args) {
+                return each<F, Lists...>(name, values(table_data), std::move(args)...);
+            }
+
+            template<template<typename...> class F, typename... Lists, typename G, typename... Args>
+            typename std::enable_if<is_generator<G>::value || std::is_same<G, no_table>::value, easy_init &>::type
+            each(const std::string & name, G gen, Args... args) {
+                each_combination<F, G, Args...> f { *this, name, gen, std::tuple<Args...>(std::move(args)...) };
+                for_each_type<typename product<Lists...>::type>::call(f);
+                return *this;
+            }
+
+            // The fixtures registered after this use the dataset, which is
+            // then loaded once and kept until the last of them has run
+            template<typename T>
+            easy_init & uses(const dataset<T> & data) {
+                datasets.push_back(data.slot());
+                return *this;
+            }
+
+            // Sets the tolerance of a fixture registered before, such as one
+            // instantiation of each()
+            easy_init & tolerance(const std::string & name, double tolerance) {
+                auto it = fixtures.find(name);
+                if (it == std::end(fixtures)) throw std::runtime_error("no fixture " + name);
+                it->second.tolerance(tolerance);
+                return *this;
+            }
+
+            // The tolerance of F<T...> as registered by each(name, ...)
+            template<template<typename...> class F, typename... T>
+            easy_init & tolerance(const std::string & name, double tolerance) {
+                return this->tolerance(apply<F, types<T...>>::name(name), tolerance);
+            }
+
+            easy_init & add(const std::string & name, fixture_runner runner, double tolerance = -1.0) {
+                runner.order(fixtures.size());
+                runner.tolerance(tolerance);
+                runner.datasets(datasets);
+                fixtures[name] = runner;
                 return *this;
             }
         };
 
+        template<template<typename...> class F, typename G, typename... Args>
+        struct easy_init::each_combination {
+            easy_init & init;
+            const std::string & name;
+            const G & gen;
+            std::tuple<Args...> args;
+
+            template<typename Combo>
+            void operator()() {
+                typedef apply<F, Combo> fixture_type;
+                add(fixture_type::name(name), constructor<typename fixture_type::type, Args...> { args }, gen);
+            }
+
+            template<typename Factory>
+            void add(const std::string & name, Factory factory, const no_table &) { init(name, std::move(factory)); }
+
+            template<typename Factory, typename Gen>
+            void add(const std::string & name, Factory factory, const Gen & gen) { init(name, std::move(factory), gen); }
+        };
+
         struct empty_fixture : fixture {
             int dummy;
             virtual void go() { result(&dummy); }
         };
+
+        struct inline_empty_fixture : inline_fixture<inline_empty_fixture> {
+            int dummy;
+            virtual void go() { result(&dummy); }
+        };
+
+        // Cycles of an empty run, subtracted from every run of a fixture
+        // timed the same way
+        struct loop_overhead {
+            uint64_t dispatched;  // go() through the vtable
+            uint64_t inlined;     // inline_fixture
+
+            uint64_t of(const fixture & f) const { return dynamic_cast<const inlined_tag*>(&f) ? inlined : dispatched; }
+        };
     }
 
     namespace opt {
@@ -240,7 +1038,36 @@ namespace mbm {
         const opt_t numruns { "numruns,n", "Average execution times over numruns" };
         const opt_t filter { "filter,f", "Filter benchmarks, running only those matching a regexp" };
         const opt_t group { "group,g", "Filter benchmark groups, running only those matching a regexp" };
-        const opt_t rdtsc { "rdtsc", "Force use of rdtsc even if CPU supports rdtscp" };
+        const opt_t timer { "timer", "Timer backend: cpuid, cpuid-rdtscp, lfence, rdtscp or clock" };
+        const opt_t counters { "counters", "Collect hardware performance counters (IPC, cache, branch and TLB misses)" };
+        const opt_t allocs { "allocs", "Count allocations (needs MBM_ALLOC_HOOKS) and page faults in each timed run" };
+        const opt_t batch { "batch", "Repeat go() within each timed run until a run covers at least this many cycles, unless the fixture is not batchable()" };
+        const opt_t precision { "precision", "Sample until the 95% confidence interval is within +/- this fraction (e.g. 0.005)" };
+        const opt_t estimator { "estimator", "Estimator the precision target applies to: median or mean" };
+        const opt_t min_runs { "min-runs", "Minimum runs when sampling to a precision target" };
+        const opt_t max_runs { "max-runs", "Maximum runs when sampling to a precision target" };
+        const opt_t budget { "budget", "Time budget in seconds per fixture when sampling to a precision target" };
+        const opt_t baseline { "baseline", "Fixture to compare the others in its group against (default: first registered)" };
+        const opt_t format { "format", "Report format: console, json or csv" };
+        const opt_t out { "out", "Write the report to this file instead of stdout" };
+        const opt_t save_baseline { "save-baseline", "Save the per call samples of this run to a baseline file" };
+        const opt_t compare { "compare", "Check this run for regressions against a saved baseline file" };
+        const opt_t tolerance { "tolerance", "Slowdown against --compare allowed for fixtures registered without a tolerance" };
+        const opt_t outliers { "outliers", "Outlier classification: tukey (IQR fences) or mad" };
+        const opt_t exclude_outliers { "exclude-outliers", "Outliers left out of avg and std_dev: none, severe or all" };
+        const opt_t warmup { "warmup", "Discard up to this many warmup runs per fixture until timings are steady" };
+        const opt_t warmup_budget { "warmup-budget", "Time budget in seconds for warmup per fixture" };
+        const opt_t threads { "threads", "Run threaded fixtures on each of these thread counts, e.g. 1,2,4,8" };
+        const opt_t cores { "cores", "Run fixtures in parallel, one worker pinned to each of these cpus, e.g. 2,4,6,8 or 2-8" };
+        const opt_t isolate { "isolate", "Drop --cores that share a physical core (smt) or an L3 cache (l3) with an earlier one" };
+        const opt_t cache { "cache", "Cache state for each run: warm, cold (evicted after setup) or both side by side" };
+        const opt_t env_check { "env-check", "On a noisy environment (governor, turbo, pinned core interrupts): off, warn or refuse" };
+        const opt_t irq_limit { "irq-limit", "Interrupts per second on the pinned core above which the environment is noisy" };
+        const opt_t interference { "interference", "Leave out of the statistics runs that were descheduled, migrated or hit a major fault: "
+                                       "off, mark or rerun them (needs perf_event_paranoid <= 1 or CAP_PERFMON)" };
+        const opt_t fork { "fork", "Run each fixture in a child process forked from the calibrated suite" };
+        const opt_t histogram { "histogram", "Record runs in a log-linear histogram with this many significant digits (1-5)" };
+        const opt_t warmup_dump { "warmup-dump", "Write the warmup curve of every fixture to this CSV file" };
     }
 
     struct usage_error : std::runtime_error {
@@ -252,6 +1079,7 @@ namespace mbm {
         typedef std::vector<std::string> strs_t;
 
         boost::program_options::options_description cmdline;
+        dataset_registry datasets;
 
         bool version;
         bool verbose;
@@ -259,9 +1087,42 @@ namespace mbm {
         unsigned numruns;
         strs_t filters;
         strs_t groups;
-        bool use_rdtsc;
-
-        suite(bool add_generic_opts = true) {
+        std::string timer_name;
+        timer::kind timer_kind;
+        bool use_counters;
+        bool use_allocs;
+        uint64_t batch_cycles;
+        detail::adaptive_opts adaptive;
+        std::string estimator_name;
+        detail::warmup_opts warmup;
+        std::string warmup_dump;
+        unsigned histogram_digits;
+        std::string threads_spec;
+        std::vector<unsigned> thread_counts;
+        std::string cores_spec;
+        std::vector<unsigned> cores;
+        std::string isolate_name;
+        bool fork_fixtures;
+        std::string cache_name;
+        cache_mode cache;
+        std::string interference_name;
+        interference_mode interference;
+        std::string env_check_name;
+        env_check check;
+        double irq_limit;
+        stats::config stats_cfg;
+        std::string baseline;
+        std::string format_name;
+        report::format report_format;
+        std::string out;
+        std::string save_baseline;
+        std::string compare_file;
+        double tolerance;
+        std::string outliers_name;
+        std::string exclude_name;
+
+        suite(bool add_generic_opts = true) : timer_kind(timer::default_kind()), cache(cache_warm), interference(interference_off), check(env_warn), 
+                report_format(report::console) {
             namespace po = boost::program_options;
             if (add_generic_opts) {
                 po::options_description generic("Generic Options");
@@ -282,9 +1143,71 @@ namespace mbm {
                 (opt::numruns, po::value<unsigned>(&numruns)->default_value(128u))
                 (opt::filter, po::value<strs_t>(&filters)
                     ->default_value(strs_t(), ""))
-                (opt::rdtsc, po::value<bool>(&use_rdtsc)
+                (opt::timer, po::value<std::string>(&timer_name)
+                    ->default_value(timer::name(timer::default_kind())))
+                (opt::counters, po::value<bool>(&use_counters)
                     ->implicit_value(true)
-                    ->default_value(!has_rdtscp()));
+                    ->default_value(false))
+                (opt::allocs, po::value<bool>(&use_allocs)
+                    ->implicit_value(true)
+                    ->default_value(false))
+                (opt::batch, po::value<uint64_t>(&batch_cycles)
+                    ->implicit_value(10000u)
+                    ->default_value(0u))
+                (opt::precision, po::value<double>(&adaptive.precision)
+                    ->implicit_value(0.005)
+                    ->default_value(0.0))
+                (opt::estimator, po::value<std::string>(&estimator_name)
+                    ->default_value(stats::name(stats::median)))
+                (opt::min_runs, po::value<unsigned>(&adaptive.min_runs)
+                    ->default_value(16u))
+                (opt::max_runs, po::value<unsigned>(&adaptive.max_runs)
+                    ->default_value(1000000u))
+                (opt::budget, po::value<double>(&adaptive.budget)
+                    ->default_value(10.0))
+                (opt::baseline, po::value<std::string>(&baseline)
+                    ->default_value(std::string(), ""))
+                (opt::format, po::value<std::string>(&format_name)
+                    ->default_value(report::name(report::console)))
+                (opt::out, po::value<std::string>(&out)
+                    ->default_value(std::string(), ""))
+                (opt::save_baseline, po::value<std::string>(&save_baseline)
+                    ->default_value(std::string(), ""))
+                (opt::compare, po::value<std::string>(&compare_file)
+                    ->default_value(std::string(), ""))
+                (opt::tolerance, po::value<double>(&tolerance)
+                    ->default_value(0.05))
+                (opt::outliers, po::value<std::string>(&outliers_name)
+                    ->default_value(stats::name(stats_cfg.outliers)))
+                (opt::exclude_outliers, po::value<std::string>(&exclude_name)
+                    ->default_value(stats::name(stats_cfg.exclude)))
+                (opt::warmup, po::value<unsigned>(&warmup.max_runs)
+                    ->implicit_value(1000u)
+                    ->default_value(0u))
+                (opt::warmup_budget, po::value<double>(&warmup.budget)
+                    ->default_value(1.0))
+                (opt::threads, po::value<std::string>(&threads_spec)
+                    ->default_value(std::string(), ""))
+                (opt::cores, po::value<std::string>(&cores_spec)
+                    ->default_value(std::string(), ""))
+                (opt::isolate, po::value<std::string>(&isolate_name)
+                    ->default_value(name(isolate_none)))
+                (opt::cache, po::value<std::string>(&cache_name)
+                    ->default_value(name(cache_warm)))
+                (opt::env_check, po::value<std::string>(&env_check_name)
+                    ->default_value(name(env_warn)))
+                (opt::irq_limit, po::value<double>(&irq_limit)
+                    ->default_value(1000.0))
+                (opt::interference, po::value<std::string>(&interference_name)
+                    ->default_value(name(interference_off)))
+                (opt::fork, po::value<bool>(&fork_fixtures)
+                    ->implicit_value(true)
+                    ->default_value(false))
+                (opt::histogram, po::value<unsigned>(&histogram_digits)
+                    ->implicit_value(3u)
+                    ->default_value(0u))
+                (opt::warmup_dump, po::value<std::string>(&warmup_dump)
+                    ->default_value(std::string(), ""));
             cmdline.add(benchmark);
         }
 
@@ -301,33 +1224,133 @@ namespace mbm {
             vm.notify();
 
             if (vm.count(opt::long_name(opt::help))) throw usage_error();
-
-            if (verbose) std::cout << "Iterations: " << numruns << std::endl;
-            if (verbose) std::cout << "Using rdtsc: " << (use_rdtsc ? "yes" : "no") << std::endl;
+            if (!report::parse(format_name, report_format))
+                throw usage_error("unknown report format " + format_name);
+
+            if (verbose) log() << "Iterations: " << numruns << std::endl;
+            if (!timer::parse(timer_name, timer_kind)) 
+                throw usage_error("unknown or unsupported timer " + timer_name);
+            if (!stats::parse(estimator_name, adaptive.estimator))
+                throw usage_error("unknown estimator " + estimator_name);
+            if (!stats::parse(outliers_name, stats_cfg.outliers))
+                throw usage_error("unknown outlier method " + outliers_name);
+            if (!stats::parse(exclude_name, stats_cfg.exclude))
+                throw usage_error("unknown outlier exclusion " + exclude_name);
+            if (adaptive.min_runs > adaptive.max_runs)
+                throw usage_error("min-runs must not exceed max-runs");
+            thread_counts = parse_thread_counts(threads_spec);
+            if (verbose && !thread_counts.empty()) 
+                log() << "Threads: " << threads_spec << " on " << online_cpus() << " cpus" << std::endl;
+            if (!thread_counts.empty() && thread_counts.back() > online_cpus())
+                std::cerr << "Warning - " << thread_counts.back() << " threads on " << online_cpus() 
+                    << " cpus, threads will share cpus" << std::endl;
+            if (!thread_counts.empty() && (warmup.max_runs || adaptive.precision > 0.0))
+                std::cerr << "Warning - warmup and precision do not apply to threaded rows, "
+                    "which take numruns rounds" << std::endl;
+            parse_cores();
+            if (fork_fixtures && !cores.empty())
+                throw usage_error("fork and cores cannot be combined");
+            if (!parse(env_check_name, check))
+                throw usage_error("unknown environment check " + env_check_name);
+            if (!parse(cache_name, cache))
+                throw usage_error("unknown cache mode " + cache_name);
+            if (cache != cache_warm && cores.size() > 1 && isolate_name != name(isolate_l3))
+                throw usage_error("cold runs on several cores sweep a shared L3 under the other workers, use --isolate=l3");
+            if (cache != cache_warm && verbose) 
+                log() << "Cold runs: " << (shared_evictor().size() >> 10) << "K sweep" << std::endl;
+            if (histogram_digits > 5)
+                throw usage_error("histogram precision must be 1 to 5 digits");
+            if (verbose && histogram_digits) 
+                log() << "Histogram: " << histogram_digits << " significant digits" << std::endl;
+            if (tolerance < 0.0)
+                throw usage_error("tolerance must not be negative");
+            if (verbose && batch_cycles) log() << "Batching runs to: " << batch_cycles << "clk" << std::endl;
+            if (!warmup_dump.empty() && !warmup.max_runs)
+                throw usage_error("warmup-dump requires warmup");
+            if (verbose && warmup.max_runs)
+                log() << "Warmup: up to " << warmup.max_runs << " runs, " << warmup.budget << "s budget" << std::endl;
+            if (verbose && adaptive.precision > 0.0) 
+                log() << "Sampling to: +/-" << adaptive.precision * 100.0 << "% of " 
+                    << stats::name(adaptive.estimator) << ", " << adaptive.min_runs << '-' << adaptive.max_runs 
+                    << " runs, " << adaptive.budget << "s budget" << std::endl;
+            if (verbose) log() << "TSC frequency: " << tsc_frequency() << std::endl;
+
+            if (use_counters) {
+                counter_group probe;
+                if (!probe.ok()) {
+                    std::cerr << "Hardware counters unavailable - " << probe.error() << std::endl;
+                    use_counters = false;
+                }
+            }
+            if (verbose) log() << "Using hardware counters: " << (use_counters ? "yes" : "no") << std::endl;
+
+            if (!parse(interference_name, interference))
+                throw usage_error("unknown interference mode " + interference_name);
+            if (interference != interference_off) {
+                interference_monitor probe;
+                if (!probe.ok()) {
+                    std::cerr << "Interference detection unavailable - " << probe.error() << std::endl;
+                    interference = interference_off;
+                }
+            }
+            if (use_allocs && !alloc_hooks())
+                std::cerr << "Warning - allocation hooks not linked, define MBM_ALLOC_HOOKS in one source file; "
+                    "counting page faults only" << std::endl;
         }
 
         void add(const std::string & name, std::function<fixture*(void)> factory) { 
-            fixtures_[name] = detail::fixture_runner("", use_rdtsc, std::move(factory));
+            detail::easy_init(fixtures_, "")(name, std::move(factory));
         }
 
         template<typename T>
         void add(const std::string & name, std::function<fixture*(void)> factory, std::initializer_list<T> table_data) { 
-            fixtures_[name] = detail::fixture_runner("", use_rdtsc, std::move(factory), std::move(table_data));
+            detail::easy_init(fixtures_, "")(name, std::move(factory), std::move(table_data));
+        }
+
+        void add(const std::string & name, std::function<fixture*(void)> factory, double tolerance) { 
+            detail::easy_init(fixtures_, "")(name, std::move(factory), tolerance);
+        }
+
+        template<typename T>
+        void add(const std::string & name, std::function<fixture*(void)> factory, std::initializer_list<T> table_data,
+                 double tolerance) { 
+            detail::easy_init(fixtures_, "")(name, std::move(factory), std::move(table_data), tolerance);
+        }
+
+        template<typename G>
+        typename std::enable_if<is_generator<G>::value>::type
+        add(const std::string & name, std::function<fixture*(void)> factory, G gen, double tolerance = -1.0) { 
+            detail::easy_init(fixtures_, "")(name, std::move(factory), std::move(gen), tolerance);
+        }
+
+        template<typename F, typename G>
+        typename std::enable_if<detail::is_table_factory<F>::value && is_generator<G>::value>::type
+        add(const std::string & name, F factory, G gen, double tolerance = -1.0) { 
+            detail::easy_init(fixtures_, "")(name, std::move(factory), std::move(gen), tolerance);
+        }
+
+        template<typename F, typename T>
+        typename std::enable_if<detail::is_table_factory<F>::value>::type
+        add(const std::string & name, F factory, std::initializer_list<T> table_data, double tolerance = -1.0) { 
+            detail::easy_init(fixtures_, "")(name, std::move(factory), std::move(table_data), tolerance);
         }
 
         detail::easy_init add(const std::string & group) {
-            return detail::easy_init(fixtures_, use_rdtsc, group);
+            return detail::easy_init(fixtures_, group);
         }
         
-        void run() const {
+        // Returns the number of regressions against --compare
+        unsigned run() const {
             set_affinity();
+            auto env = check_environment();
+            calibrate_timers();
             auto overhead = compute_overhead();
             auto filtered = filter_fixtures();
             if (!filtered.size()) {
-                std::cout << "No fixtures matched filter specs" << std::endl;
-                return;
+                log() << "No fixtures matched filter specs" << std::endl;
+                return 0;
             }
-            run(overhead, filtered);
+            return run(overhead, filtered, env);
         }
 
     private:
@@ -344,19 +1367,63 @@ namespace mbm {
             CPU_SET(pincore, &cpus);
             if (sched_setaffinity(0, 1, &cpus)) 
                throw std::runtime_error(strerror(errno)); 
-            if (verbose) std::cout << "Pinning to core: " << pincore << std::endl;
+            if (verbose) log() << "Pinning to core: " << pincore << std::endl;
         }
 
-        uint64_t compute_overhead() const {
-            if (verbose) std::cout << "Computing loop overhead..." << std::flush;
+        // Refuses to run on a noisy machine with --env-check=refuse
+        environment check_environment() const {
+            auto res = capture_environment(pincore, check == env_off ? 0.0 : 0.1);
+            if (check == env_off) return res;
+            auto problems = res.problems(irq_limit);
+            if (problems.empty()) return res;
+            std::string all;
+            for (const auto & p : problems) all += (all.empty() ? "" : ", ") + p;
+            if (check == env_refuse) throw std::runtime_error("noisy environment - " + all);
+            std::cerr << "Warning - noisy environment: " << all << std::endl;
+            return res;
+        }
+
+        void calibrate_timers() const {
+            if (verbose) log() << "Calibrating timers..." << std::endl;
+            std::vector<timer::calibration> cals(timer::kind_count);
+            auto best = timer_kind;
+            for (auto i = 0; i < timer::kind_count; i++) {
+                auto k = static_cast<timer::kind>(i);
+                if (!timer::available(k)) continue;
+                cals[k] = timer::calibrate(k);
+                if (cals[k].jitter() < cals[best].jitter()) best = k;
+                if (verbose) 
+                    log() << indent() << (k == timer_kind ? '*' : ' ') << std::setw(13) << timer::name(k) 
+                        << ": min=" << cals[k].min << "clk, median=" << cals[k].median 
+                        << "clk, jitter=" << cals[k].jitter() << "clk" << std::endl;
+            }
+            if (cals[timer_kind].jitter() > 4.0 * cals[best].jitter() + 100.0)
+                std::cerr << "Warning - timer " << timer::name(timer_kind) << " jitter is " 
+                    << cals[timer_kind].jitter() << "clk, consider --timer=" << timer::name(best) << std::endl;
+        }
+
+        detail::loop_overhead compute_overhead() const {
+            if (verbose) log() << "Computing loop overhead..." << std::flush;
+            auto res = measure_overhead();
+            if (verbose) log() << "Done. " << res.dispatched << "clk, " << res.inlined << "clk inlined" << std::endl;
+            return res;
+        }
+
+        // Minimum cycles of an empty run on the calling thread's core
+        detail::loop_overhead measure_overhead() const {
+            return detail::loop_overhead { 
+                measure_overhead(detail::fixture_runner("", [] { return new detail::empty_fixture(); })),
+                measure_overhead(detail::fixture_runner("", [] { return new detail::inline_empty_fixture(); })) 
+            };
+        }
+
+        uint64_t measure_overhead(const detail::fixture_runner & empty_runner) const {
             uint64_t res = std::numeric_limits<uint64_t>::max();
-            detail::fixture_runner empty_runner("", use_rdtsc, [] { return new detail::empty_fixture(); });
             for (auto i = 0u; i < 1000000u / numruns; i++) {
-                auto runres = run(empty_runner);
+                auto runres = run(empty_runner, detail::run_opts(numruns, timer_kind)).samples;
                 runres.emplace_back(res);
                 res = *(std::min_element(std::begin(runres), std::end(runres)));
             }
-            if (verbose) std::cout << "Done. " << res << "clk" << std::endl;
             return res;
         }
 
@@ -403,95 +1470,651 @@ namespace mbm {
             return res != filters.end();
         }
 
-        void run(uint64_t overhead, const fixture_map_t & fixtures) const {
-            std::cout << "Running benchmarks..." << std::flush;
-            std::multimap<std::string, std::string> results;
-            std::transform(std::begin(fixtures), std::end(fixtures), 
-                    std::inserter(results, std::begin(results)),
-                    [&](decltype(*std::end(fixtures_)) _) { 
-                        return std::make_pair(_.second.group(), run(overhead, _.first, _.second)); 
-                    });
-            std::cout << "Done." << std::endl;
-
-            std::string last;
-            std::for_each(std::begin(results), std::end(results), [&](decltype(*std::end(results)) r) { 
-                        auto group = r.first.empty() ? "Ungrouped" : r.first;
-                        if (group != last) 
-                            std::cout << std::string(10, '=') << ' ' << group << ' ' << std::string(10, '=') << std::endl;
-                        std::cout << r.second << std::endl; 
-                        last = group;
+        unsigned run(const detail::loop_overhead & overhead, const fixture_map_t & fixtures, const environment & env) const {
+            baseline::results_t saved;
+            if (!compare_file.empty()) saved = baseline::load(compare_file);
+
+            std::unique_ptr<std::ofstream> dump;
+            if (!warmup_dump.empty()) {
+                dump.reset(new std::ofstream(warmup_dump));
+                if (!*dump) throw std::runtime_error("unable to open " + warmup_dump);
+                *dump << "group,fixture,param,run,cycles\n";
+            }
+
+            std::unique_ptr<std::ofstream> file;
+            if (!out.empty()) {
+                file.reset(new std::ofstream(out));
+                if (!*file) throw std::runtime_error("unable to open " + out);
+            }
+            auto rep = report::make(report_format, file ? *file : std::cout, verbose);
+            rep->begin(context(overhead, env));
+
+            // Group order, so results are reported the same way however they are scheduled
+            std::vector<fixture_map_t::const_iterator> work;
+            for (auto it = std::begin(fixtures); it != std::end(fixtures); ++it) work.push_back(it);
+            std::stable_sort(std::begin(work), std::end(work), 
+                    [](fixture_map_t::const_iterator a, fixture_map_t::const_iterator b) { 
+                        return a->second.group() < b->second.group(); 
                     });
+
+            detail::dataset_pins pins;
+            for (auto it : work) pins.acquire(it->second.datasets());
+
+            std::vector<std::promise<fixture_runs>> pending(work.size());
+            std::unique_ptr<thread_team> workers;
+            if (!cores.empty()) workers = schedule(work, pending);
+
+            results_t results;
+            unsigned complexity_changes = 0;
+            for (size_t i = 0; i < work.size(); i++) {
+                auto group = work[i]->second.group();
+                if (!i || group != work[i - 1]->second.group()) rep->begin_group(group);
+
+                auto res = workers ? pending[i].get_future().get() 
+                                   : fork_fixtures ? run_forked(overhead, work[i]->first, work[i]->second)
+                                                   : run(overhead, work[i]->first, work[i]->second);
+                pins.release(work[i]->second.datasets());
+                for (const auto & row : res.rows) {
+                    rep->result(make_result(group, res, row));
+                    if (dump) dump_warmup(*dump, res.overhead, group, res.name, row.first, row.second);
+                }
+                results.emplace(group, std::move(res));
+
+                if (i + 1 == work.size() || group != work[i + 1]->second.group()) {
+                    auto range = results.equal_range(group);
+                    compare(*rep, range.first, range.second);
+                    for (auto it = range.first; it != range.second; ++it) 
+                        scaling(*rep, group, it->second);
+                    for (auto it = range.first; it != range.second; ++it) 
+                        complexity_changes += complexity(*rep, group, it->second, saved);
+                    rep->end_group(group);
+                }
+            }
+
+            if (!save_baseline.empty()) baseline::save(save_baseline, to_baseline(results));
+            auto regressions = compare_file.empty() ? 0 : check_regressions(*rep, results, saved);
+            rep->end();
+            return regressions + complexity_changes;
+        }
+
+        struct fixture_runs {
+            std::string name;
+            size_t order;
+            double tolerance;
+            bool table;
+            uint64_t overhead;  // of the kind of fixture, measured on the core it ran on
+            run_table_t rows;   // a single row with an empty parameter unless table
+        };
+        typedef std::multimap<std::string, fixture_runs> results_t;
+
+        // One worker per core takes the next fixture in order, after pinning
+        // itself and measuring its own timing overhead
+        std::unique_ptr<thread_team> schedule(const std::vector<fixture_map_t::const_iterator> & work,
+                                              std::vector<std::promise<fixture_runs>> & pending) const {
+            auto next = std::make_shared<std::atomic<size_t>>(0);
+            return std::unique_ptr<thread_team>(new thread_team(cores.size(), cores, [=, &work, &pending](unsigned) {
+                        auto overhead = measure_overhead();
+                        for (size_t i; (i = (*next)++) < work.size(); ) {
+                            try {
+                                pending[i].set_value(run(overhead, work[i]->first, work[i]->second));
+                            } catch (...) {
+                                pending[i].set_exception(std::current_exception());
+                            }
+                        }
+                    }));
+        }
+
+        fixture_runs run(const detail::loop_overhead & overhead, const std::string & name, const detail::fixture_runner & runner) const {
+            auto res = make_runs(name, runner);
+            res.rows = run_table(runner, overhead, res.overhead);
+            return res;
         }
 
-        std::string run(uint64_t overhead, const std::string & name, const detail::fixture_runner & runner) const {
-            std::ostringstream res_stm;
-            if (runner.is_table()) {
-                auto res = run_table(runner);
-                std::for_each(std::begin(res), std::end(res), [&](decltype(*std::end(res)) _) {
-                            res_stm << name << "(" << _.first << ")";
-                            report(res_stm, overhead, _.second);
-                            res_stm << '\n';
+        fixture_runs make_runs(const std::string & name, const detail::fixture_runner & runner) const {
+            return fixture_runs { name, runner.order(), runner.tolerance() < 0.0 ? tolerance : runner.tolerance(), 
+                                  runner.is_table(), 0, run_table_t() };
+        }
+
+        // Runs the fixture in a child forked from this process, so it starts from
+        // the calibrated timers and pinning but none of the heap or cache state
+        // left by the fixtures before it. The rows come back over a pipe as
+        // 'r', the overhead, the row count, then each parameter and run_res_t; a
+        // failure as 'e' and its message.
+        fixture_runs run_forked(const detail::loop_overhead & overhead, const std::string & name, const detail::fixture_runner & runner) const {
+            for (auto & data : runner.datasets()) data->load();  // once, shared with the child copy on write
+            int fds[2];
+            if (pipe(fds)) throw std::runtime_error(std::string("pipe: ") + strerror(errno));
+            std::cout.flush();
+            std::cerr.flush();
+            auto pid = ::fork();
+            if (pid < 0) {
+                auto err = errno;
+                close(fds[0]);
+                close(fds[1]);
+                throw std::runtime_error(std::string("fork: ") + strerror(err));
+            }
+
+            if (!pid) {
+                close(fds[0]);
+                auto status = 0;
+                try {
+                    detail::fd_writer out(fds[1]);
+                    try {
+                        auto res = run(overhead, name, runner);
+                        out.put('r');
+                        out.put(res.overhead);
+                        out.put<uint64_t>(res.rows.size());
+                        for (const auto & row : res.rows) {
+                            out.put(row.first);
+                            row.second.write(out);
+                        }
+                    } catch (const std::exception & e) {
+                        out.put('e');
+                        out.put(std::string(e.what()));
+                        status = 1;
+                    }
+                    out.flush();
+                } catch (...) {
+                    status = 1;
+                }
+                _exit(status);  // no atexit handlers or stdio flushes of the parent's state
+            }
+
+            close(fds[1]);
+            auto res = make_runs(name, runner);
+            std::string error;
+            std::exception_ptr failure;
+            try {
+                detail::fd_reader in(fds[0]);
+                if (in.get<char>() == 'e') {
+                    in.get(error);
+                } else {
+                    in.get(res.overhead);
+                    res.rows.resize(in.get<uint64_t>());
+                    for (auto & row : res.rows) {
+                        in.get(row.first);
+                        row.second.read(in);
+                    }
+                }
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            close(fds[0]);
+
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR) ;
+            if (!error.empty()) throw std::runtime_error(name + ": " + error);
+            if (WIFSIGNALED(status)) 
+                throw std::runtime_error(name + ": killed by signal " + std::to_string(WTERMSIG(status)));
+            if (failure) std::rethrow_exception(failure);
+            return res;
+        }
+
+        run_context context(const detail::loop_overhead & overhead, const environment & env) const {
+            run_context res;
+            res.env = env;
+            res.timer = timer::name(timer_kind);
+            res.tsc = tsc_frequency();
+            res.cpu = cpu_model();
+            res.pincore = pincore;
+            res.numruns = numruns;
+            res.overhead = overhead.dispatched;
+            res.inline_overhead = overhead.inlined;
+            res.batch_cycles = batch_cycles;
+            res.counters = use_counters;
+            res.allocs = use_allocs;
+            res.alloc_hooks = alloc_hooks();
+            res.interference = interference != interference_off;
+            res.warmup = warmup.max_runs > 0;
+            res.cache = name(cache);
+            res.precision = adaptive.precision;
+            res.estimator = adaptive.estimator;
+            res.stats = stats_cfg;
+            res.compare_file = compare_file;
+            return res;
+        }
+
+        fixture_result make_result(const std::string & group, const fixture_runs & runs,
+                                   const run_table_t::value_type & row) const {
+            const auto & res = row.second;
+            fixture_result r;
+            r.group = group;
+            r.name = runs.name;
+            r.param = row.first;
+            r.table = runs.table;
+            r.elements = res.elements;
+            r.params = res.params;
+            r.samples = res.per_call(runs.overhead);
+            r.summary = res.hist.enabled() ? stats::summarize(res.hist, stats_cfg).scale(1.0 / res.batch) 
+                : stats::summarize(r.samples, stats_cfg);
+            r.hist = res.hist.enabled() ? &res.hist : nullptr;
+            r.warmup = res.warmup.size();
+            r.steady = res.steady;
+            r.batch = res.batch;
+            r.stop = res.stop == run_res_t::fixed ? nullptr : res.stop_reason();
+            r.precision = res.precision;
+            r.counters = res.counters;
+            r.allocs = res.allocs;
+            r.interference = res.interference;
+            r.threads = res.threads;
+            r.cold = res.cold;
+            r.throughput = throughput(runs.overhead, res);
+            r.items = res.items;
+            r.bytes = res.bytes;
+            return r;
+        }
+
+        // Calls per second over all threads, from the median round
+        static double throughput(uint64_t overhead, const run_res_t & res) {
+            if (res.rounds.empty()) return 0.0;
+            std::vector<double> rounds(std::begin(res.rounds), std::end(res.rounds));
+            std::sort(std::begin(rounds), std::end(rounds));
+            auto cycles = std::max(1.0, stats::quantile(rounds, 0.5) - overhead);
+            return res.threads * res.batch * clocks_per_microsecond() * 1e6 / cycles;
+        }
+
+        static std::string row_key(const run_table_t::value_type & row) {
+            auto res = row.second.threads ? row.first + "@" + std::to_string(row.second.threads) + "t" : row.first;
+            return row.second.cold ? res + "@cold" : res;
+        }
+
+        // Throughput of every threaded row against the same parameter on the
+        // fewest threads
+        void scaling(reporter & rep, const std::string & group, const fixture_runs & runs) const {
+            std::map<std::string, std::vector<const run_table_t::value_type*>> params;
+            for (const auto & row : runs.rows)
+                if (row.second.threads) params[row.second.cold ? row.first + "@cold" : row.first].push_back(&row);
+            for (auto & p : params) {
+                if (p.second.size() < 2) continue;
+                std::sort(std::begin(p.second), std::end(p.second), 
+                        [](const run_table_t::value_type * a, const run_table_t::value_type * b) { 
+                            return a->second.threads < b->second.threads; 
                         });
-            } else {
-                auto res = run(runner);
-                report(res_stm, overhead, res);
+                scaling_result res;
+                res.group = group;
+                res.name = runs.name;
+                res.param = p.second.front()->first;
+                res.table = runs.table;
+                res.cold = p.second.front()->second.cold;
+                const auto & base = p.second.front()->second;
+                auto base_tp = throughput(runs.overhead, base);
+                for (auto row : p.second) {
+                    const auto & r = row->second;
+                    scaling_result::point pt;
+                    pt.threads = r.threads;
+                    pt.throughput = throughput(runs.overhead, r);
+                    pt.speedup = base_tp > 0.0 ? pt.throughput / base_tp : 0.0;
+                    pt.efficiency = pt.speedup * base.threads / r.threads;
+                    auto lat = r.per_call(runs.overhead);
+                    std::sort(std::begin(lat), std::end(lat));
+                    pt.latency = stats::quantile(lat, 0.5);
+                    res.points.push_back(pt);
+                }
+                rep.scaling(res);
             }
-            std::cout << "." << std::flush;
-            return res_stm.str();
         }
 
-        static std::string indent(size_t chars = 8) { return std::string(chars, ' '); }
-        template<typename Iterator>
-        static double compute_stddev(Iterator begin, Iterator end, double avg) {
-            double res = std::accumulate(begin, end, 0.0, [avg](double r, decltype(*end) t) {
-                        auto offs = t - avg;
-                        return r + offs * offs;
-                    });
-            return sqrt(res / std::distance(begin, end));
+        // Best fitting complexity of a table fixture over the elements of its
+        // rows, for each thread count and cache state with three or more
+        // distinct element counts. With --compare the same rows of the
+        // baseline are fitted too; returns the fits that moved to a higher order.
+        unsigned complexity(reporter & rep, const std::string & group, const fixture_runs & runs, 
+                            const baseline::results_t & saved) const {
+            if (!runs.table) return 0;
+            // Rows sharing the dimensions after the first, thread count and cache state
+            typedef std::tuple<std::string, unsigned, bool> variant_t;
+            std::map<variant_t, std::vector<const run_table_t::value_type*>> variants;
+            for (const auto & row : runs.rows) {
+                if (row.second.elements <= 0.0) continue;
+                auto comma = row.first.find(',');
+                auto rest = comma == std::string::npos ? std::string() : row.first.substr(comma + 1);
+                variants[variant_t(rest, row.second.threads, row.second.cold)].push_back(&row);
+            }
+
+            unsigned regressions = 0;
+            for (const auto & v : variants) {
+                std::vector<double> n, current, base;
+                for (auto row : v.second) {
+                    n.push_back(row->second.elements);
+                    current.push_back(median_of(to_ns(row->second.per_call(runs.overhead))));
+                    auto it = saved.find(baseline::key_t(group, runs.name, row_key(*row)));
+                    if (it != std::end(saved)) base.push_back(median_of(it->second.samples));
+                }
+                if (std::set<double>(std::begin(n), std::end(n)).size() < 3) continue;
+
+                complexity_result res;
+                res.group = group;
+                res.name = runs.name;
+                res.param = std::get<0>(v.first);
+                res.threads = std::get<1>(v.first);
+                res.cold = std::get<2>(v.first);
+                res.fit = stats::fit_complexity(n, current);
+                res.saved = base.size() == n.size();
+                res.baseline = res.saved ? stats::fit_complexity(n, base) : res.fit;
+                // Only a change both runs are clear about, not a flip between close fits
+                res.regression = res.fit.model > res.baseline.model && 
+                    stats::prefers(res.fit.model, res.baseline.model, n, current) && 
+                    stats::prefers(res.baseline.model, res.fit.model, n, base);
+                if (res.regression) regressions++;
+                rep.complexity(res);
+            }
+            return regressions;
+        }
+
+        static double median_of(std::vector<double> values) {
+            std::sort(std::begin(values), std::end(values));
+            return stats::quantile(values, 0.5);
+        }
+
+        // Speedup of every fixture in a group relative to the group baseline,
+        // matching table rows by parameter
+        void compare(reporter & rep, results_t::const_iterator first, results_t::const_iterator last) const {
+            if (std::distance(first, last) < 2) return;
+            auto base = std::find_if(first, last, [&](decltype(*first) r) { return r.second.name == baseline; });
+            if (base == last)
+                base = std::min_element(first, last, [](decltype(*first) a, decltype(*first) b) { 
+                            return a.second.order < b.second.order; 
+                        });
+
+            for (auto it = first; it != last; ++it) {
+                if (it == base) continue;
+                for (const auto & row : it->second.rows) {
+                    auto match = std::find_if(std::begin(base->second.rows), std::end(base->second.rows),
+                            [&](decltype(row) b) { return row_key(b) == row_key(row); });
+                    if (match == std::end(base->second.rows)) continue;
+
+                    comparison_result res;
+                    res.group = it->first;
+                    res.baseline = base->second.name;
+                    res.name = it->second.name;
+                    res.param = row.first;
+                    res.table = it->second.table;
+                    res.threads = row.second.threads;
+                    res.cold = row.second.cold;
+                    res.per_item = match->second.items > 0.0 && row.second.items > 0.0;
+                    res.cmp = stats::compare(per_item(match->second.per_call(base->second.overhead), match->second.items), 
+                                             per_item(row.second.per_call(it->second.overhead), row.second.items), stats_cfg);
+                    rep.comparison(res);
+                }
+            }
         }
 
-        void report(std::ostream & stm, uint64_t overhead, const run_res_t & res) const {
-            run_res_t adj;
-            std::transform(std::begin(res), std::end(res), std::inserter(adj, std::begin(adj)), 
-                    [overhead](uint64_t t) { return t - overhead; });
-            auto total = std::accumulate(std::begin(adj), std::end(adj), 0ul);
-            auto avg = static_cast<double>(total) / numruns;
+        // Times per declared item, as they are without items
+        static std::vector<double> per_item(std::vector<double> times, double items) {
+            if (items > 0.0)
+                for (auto & t : times) t /= items;
+            return times;
+        }
+
+        static std::vector<double> to_ns(std::vector<double> per_call) {
+            auto scale = 1000.0 / clocks_per_microsecond();
+            for (auto & v : per_call) v *= scale;
+            return per_call;
+        }
 
-            auto stddev = compute_stddev(std::begin(adj), std::end(adj), avg);
+        static baseline::results_t to_baseline(const results_t & results) {
+            baseline::results_t res;
+            for (const auto & r : results)
+                for (const auto & row : r.second.rows)
+                    res[baseline::key_t(r.first, r.second.name, row_key(row))] = 
+                        baseline::entry { row.second.items, to_ns(row.second.per_call(r.second.overhead)) };
+            return res;
+        }
 
-            run_res_t sorted(adj);
-            std::sort(std::begin(sorted), std::end(sorted));
+        // Every fixture against its saved samples. A regression is a significant
+        // slowdown larger than the fixture's tolerance. Saved entries the
+        // filters select but nothing ran for, e.g. of a renamed fixture, are
+        // reported as missing.
+        unsigned check_regressions(reporter & rep, const results_t & results, 
+                                   const baseline::results_t & saved) const {
+            unsigned regressions = 0;
+            std::set<baseline::key_t> matched;
+            for (const auto & r : results) {
+                for (const auto & row : r.second.rows) {
+                    regression_result res;
+                    res.current = true;
+                    res.group = r.first;
+                    res.name = r.second.name;
+                    res.param = row.first;
+                    res.table = r.second.table;
+                    res.threads = row.second.threads;
+                    res.cold = row.second.cold;
+                    res.tolerance = r.second.tolerance;
+                    res.regression = false;
+
+                    auto it = saved.find(baseline::key_t(r.first, r.second.name, row_key(row)));
+                    res.saved = it != std::end(saved);
+                    if (res.saved) matched.insert(it->first);
+                    res.per_item = res.saved && it->second.items > 0.0 && row.second.items > 0.0;
+                    auto current = to_ns(row.second.per_call(r.second.overhead));
+                    if (res.per_item) current = per_item(std::move(current), row.second.items);
+                    std::sort(std::begin(current), std::end(current));
+                    res.current_ns = stats::quantile(current, 0.5);
+                    if (!res.saved) {
+                        res.baseline_ns = res.change = 0.0;
+                        res.status = "new";
+                        rep.regression(res);
+                        continue;
+                    }
+
+                    auto base = res.per_item ? per_item(it->second.samples, it->second.items) : it->second.samples;
+                    std::sort(std::begin(base), std::end(base));
+                    res.baseline_ns = stats::quantile(base, 0.5);
+                    auto cmp = stats::compare(base, current, stats_cfg);
+                    res.change = 1.0 / cmp.ratio - 1.0;
+                    res.status = "within noise";
+                    if (cmp.direction() > 0) 
+                        res.status = "faster";
+                    else if (cmp.direction() < 0 && res.change > res.tolerance) {
+                        res.status = "REGRESSION";
+                        res.regression = true;
+                        regressions++;
+                    } else if (cmp.direction() < 0) 
+                        res.status = "slower, within tolerance";
+                    rep.regression(res);
+                }
+            }
+
+            for (const auto & entry : saved) {
+                const auto & group = std::get<0>(entry.first);
+                const auto & name = std::get<1>(entry.first);
+                if (matched.count(entry.first) || !selected(group, name)) continue;
+                regression_result res;
+                res.group = group;
+                res.name = name;
+                res.param = std::get<2>(entry.first);
+                res.cold = strip_suffix(res.param, "@cold");
+                std::smatch m;
+                static const std::regex threads("(.*)@([0-9]+)t");
+                res.threads = 0;
+                if (std::regex_match(res.param, m, threads)) {
+                    res.threads = std::stoul(m[2]);
+                    res.param = m[1];
+                }
+                res.table = !res.param.empty();
+                res.saved = true;
+                res.current = false;
+                res.per_item = false;
+                auto base = entry.second.samples;
+                std::sort(std::begin(base), std::end(base));
+                res.baseline_ns = stats::quantile(base, 0.5);
+                res.current_ns = res.change = 0.0;
+                res.tolerance = 0.0;
+                res.status = "missing";
+                res.regression = false;
+                rep.regression(res);
+            }
+            return regressions;
+        }
+
+        static bool strip_suffix(std::string & str, const std::string & suffix) {
+            if (str.size() < suffix.size() || str.compare(str.size() - suffix.size(), suffix.size(), suffix)) 
+                return false;
+            str.erase(str.size() - suffix.size());
+            return true;
+        }
+
+        // Whether the group and fixture filters select a fixture
+        bool selected(const std::string & group, const std::string & name) const {
+            auto matches = [](const strs_t & exprs, const std::string & str) {
+                if (exprs.empty()) return true;
+                filters_t regexes;
+                std::transform(std::begin(exprs), std::end(exprs), std::back_inserter(regexes), parse_regex);
+                return should_run(regexes, str);
+            };
+            return matches(groups, group) && matches(filters, name);
+        }
+
+        void parse_cores() {
+            isolation level;
+            if (!parse(isolate_name, level))
+                throw usage_error("unknown isolation " + isolate_name);
+            try {
+                cores = parse_cpu_list(cores_spec);
+            } catch (const std::invalid_argument & e) {
+                throw usage_error(e.what());
+            }
+            if (cores.empty()) return;
+            if (!thread_counts.empty())
+                throw usage_error("cores and threads cannot be combined");
+            for (auto cpu : cores)
+                if (cpu >= online_cpus()) 
+                    throw usage_error("core " + std::to_string(cpu) + " is not online");
+
+            std::vector<unsigned> dropped;
+            cores = isolate(cores, level, &dropped);
+            if (!dropped.empty()) {
+                std::cerr << "Warning - not using cores";
+                for (auto cpu : dropped) std::cerr << ' ' << cpu;
+                std::cerr << " (" << name(level) << " isolation)" << std::endl;
+            }
+            if (std::find(std::begin(cores), std::end(cores), static_cast<unsigned>(pincore)) != std::end(cores))
+                std::cerr << "Warning - core " << pincore << " also runs the suite, consider a different --pincore" << std::endl;
             if (verbose) {
-                stm << std::endl
-                    << indent() << "      min: " << as_cycles(sorted.front()) << std::endl
-                    << indent() << "      avg: " << as_cycles(avg) << std::endl
-                    << indent() << "  std_dev: " << as_cycles(stddev) << std::endl
-                    << indent() << "     % 75: " << as_cycles(sorted[static_cast<int>(numruns * 0.75)]) << std::endl
-                    << indent() << "     % 90: " << as_cycles(sorted[static_cast<int>(numruns * 0.90)]) << std::endl
-                    << indent() << "     % 99: " << as_cycles(sorted[static_cast<int>(numruns * 0.99)]) << std::endl
-                    << indent() << "      max: " << as_cycles(sorted.back());
-            } else {
-                stm << ", avg=" << as_cycles(avg) << " +/- " << as_cycles(stddev) << ", range=[" << as_cycles(sorted.front()) 
-                    << ", " << as_cycles(sorted.back()) << "]";
+                log() << "Cores:";
+                for (auto cpu : cores) log() << ' ' << cpu;
+                log() << std::endl;
+            }
+        }
+
+        static std::vector<unsigned> parse_thread_counts(const std::string & spec) {
+            std::vector<unsigned> res;
+            std::istringstream stm(spec);
+            std::string item;
+            while (std::getline(stm, item, ',')) {
+                if (item.empty() || item.size() > 4 || item.find_first_not_of("0123456789") != std::string::npos 
+                        || !std::stoul(item))
+                    throw usage_error("bad thread count " + item);
+                res.push_back(static_cast<unsigned>(std::stoul(item)));
+            }
+            std::sort(std::begin(res), std::end(res));
+            res.erase(std::unique(std::begin(res), std::end(res)), std::end(res));
+            return res;
+        }
+
+        static void dump_warmup(std::ostream & stm, uint64_t overhead, const std::string & group, const std::string & name, 
+                                const std::string & param, const run_res_t & res) {
+            auto curve = res.per_call(res.warmup, overhead);
+            auto prefix = detail::csv_quote(group) + ',' + detail::csv_quote(name) + ',' + detail::csv_quote(param) + ',';
+            for (auto i = 0u; i < curve.size(); i++)
+                stm << prefix << i << ',' << curve[i] << '\n';
+        }
+
+        static std::string indent(size_t chars = 8) { return std::string(chars, ' '); }
+
+        // Diagnostics stay off stdout when it carries a machine readable report
+        std::ostream & log() const {
+            return report_format != report::console && out.empty() ? std::cerr : std::cout;
+        }
+
+        std::unique_ptr<counter_group> open_counters() const {
+            std::unique_ptr<counter_group> res;
+            if (use_counters) {
+                res.reset(new counter_group());
+                if (!res->ok()) res.reset();
             }
+            return res;
+        }
+
+        detail::run_opts make_opts(uint64_t overhead, counter_group * counters) const {
+            detail::run_opts res(numruns, timer_kind, batch_cycles, counters);
+            res.overhead = overhead;
+            res.adaptive = adaptive;
+            res.warmup = warmup;
+            res.histogram_digits = histogram_digits;
+            // Threads start on the cpu after --pincore, which the calling
+            // thread spins on between rounds
+            auto ncpus = online_cpus();
+            for (auto i = 1u; i <= ncpus; i++) res.cpus.push_back((pincore + i) % ncpus);
+            return res;
         }
 
-        run_table_t run_table(const detail::fixture_runner & runner) const {
+        // Every row of a fixture, once per thread count of a --threads sweep
+        // for threaded fixtures. Plain fixtures have a single unnamed row.
+        // used is set to the overhead subtracted for the kind of fixture.
+        run_table_t run_table(const detail::fixture_runner & runner, const detail::loop_overhead & overhead, uint64_t & used) const {
             auto fixture = runner.setup();
             BOOST_SCOPE_EXIT(&runner, &fixture) {
                 runner.teardown(fixture);
             } BOOST_SCOPE_EXIT_END
 
-            return runner.run_table(numruns, fixture);
+            auto counters = open_counters();
+            alloc_tracker allocs;
+            std::unique_ptr<interference_monitor> monitor;
+            if (interference != interference_off) monitor.reset(new interference_monitor());
+            used = overhead.of(*fixture);
+            auto opts = make_opts(used, counters.get());
+            if (use_allocs) opts.allocs = &allocs;
+            opts.interference = monitor.get();
+            opts.rerun = interference == interference_rerun;
+            if (thread_counts.empty() || !dynamic_cast<threaded_fixture*>(fixture.get()))
+                return run_cache_rows(runner, opts, fixture);
+
+            run_table_t res;
+            opts.counters = nullptr;    // counters, allocations and interference only follow the calling thread
+            opts.allocs = nullptr;
+            opts.interference = nullptr;
+            for (auto n : thread_counts) {
+                opts.threads = n;
+                auto rows = run_cache_rows(runner, opts, fixture);
+                std::move(std::begin(rows), std::end(rows), std::back_inserter(res));
+            }
+            return res;
+        }
+
+        // Warm rows, cold rows, or with --cache=both each warm row followed
+        // by its cold twin
+        run_table_t run_cache_rows(const detail::fixture_runner & runner, const detail::run_opts & opts, 
+                                   std::unique_ptr<fixture> & fixture) const {
+            if (cache == cache_warm) return run_rows(runner, opts, fixture);
+            auto cold_opts = opts;
+            cold_opts.evict = &shared_evictor();
+            auto cold = run_rows(runner, cold_opts, fixture);
+            for (auto & row : cold) row.second.cold = true;
+            if (cache == cache_cold) return cold;
+
+            auto warm = run_rows(runner, opts, fixture);
+            run_table_t res;
+            for (size_t i = 0; i < warm.size(); i++) {
+                res.push_back(std::move(warm[i]));
+                res.push_back(std::move(cold[i]));
+            }
+            return res;
+        }
+
+        static run_table_t run_rows(const detail::fixture_runner & runner, const detail::run_opts & opts, 
+                                    std::unique_ptr<fixture> & fixture) {
+            if (runner.is_table()) return runner.run_table(opts, fixture);
+            return run_table_t(1, std::make_pair(std::string(), runner.run(opts, fixture)));
         }
 
-        run_res_t run(const detail::fixture_runner & runner) const {
+        run_res_t run(const detail::fixture_runner & runner, const detail::run_opts & opts) const {
             auto fixture = runner.setup();
             BOOST_SCOPE_EXIT(&runner, &fixture) {
                 runner.teardown(fixture);
             } BOOST_SCOPE_EXIT_END
 
-            return runner.run(numruns, fixture);
+            return runner.run(opts, fixture);
         }
     };
 }
@@ -0,0 +1,188 @@
+// =====================================================================================
+// 
+//       Filename:  threads.hpp
+// 
+//    Description:  Pinned worker threads released by a spin barrier
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 07:10:05 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_THREADS_HPP_
+#define MBM_THREADS_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sched.h>
+#include <unistd.h>
+
+namespace mbm {
+    // Sense reversing barrier. Waiters spin, yielding now and then so an
+    // oversubscribed machine still makes progress.
+    class spin_barrier {
+    public:
+        explicit spin_barrier(unsigned count) : count_(count), waiting_(0), sense_(false) { }
+
+        void wait() {
+            auto sense = sense_.load(std::memory_order_acquire);
+            if (waiting_.fetch_add(1, std::memory_order_acq_rel) == count_ - 1) {
+                waiting_.store(0, std::memory_order_relaxed);
+                sense_.store(!sense, std::memory_order_release);
+                return;
+            }
+            for (unsigned spins = 1; sense_.load(std::memory_order_acquire) == sense; spins++) {
+                asm volatile("pause");
+                if (!(spins % 1024)) std::this_thread::yield();
+            }
+        }
+
+    private:
+        const unsigned count_;
+        std::atomic<unsigned> waiting_;
+        std::atomic<bool> sense_;
+    };
+
+    inline unsigned online_cpus() {
+        auto n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? static_cast<unsigned>(n) : 1u;
+    }
+
+    // Pins the calling thread, false if the cpu is not available
+    inline bool pin_thread(unsigned cpu) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        return !sched_setaffinity(0, sizeof(cpus), &cpus);
+    }
+
+    // Kernel cpu list syntax, e.g. "0-3,8", in the order given
+    inline std::vector<unsigned> parse_cpu_list(const std::string & spec) {
+        std::vector<unsigned> res;
+        std::istringstream stm(spec);
+        std::string item;
+        auto number = [&](const std::string & s) {
+            if (s.empty() || s.size() > 4 || s.find_first_not_of("0123456789") != std::string::npos)
+                throw std::invalid_argument("bad cpu list " + spec);
+            return static_cast<unsigned>(std::stoul(s));
+        };
+        while (std::getline(stm, item, ',')) {
+            auto dash = item.find('-');
+            auto first = number(item.substr(0, dash));
+            auto last = dash == std::string::npos ? first : number(item.substr(dash + 1));
+            if (last < first) throw std::invalid_argument("bad cpu list " + spec);
+            for (auto cpu = first; cpu <= last; cpu++) res.push_back(cpu);
+        }
+        return res;
+    }
+
+    namespace detail {
+        // cpus in a sysfs list for cpu, empty if the file is missing
+        inline std::set<unsigned> sysfs_cpus(unsigned cpu, const std::string & file) {
+            std::ifstream stm("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/" + file);
+            std::string line;
+            if (!std::getline(stm, line)) return std::set<unsigned>();
+            try {
+                auto cpus = parse_cpu_list(line);
+                return std::set<unsigned>(std::begin(cpus), std::end(cpus));
+            } catch (const std::invalid_argument &) {
+                return std::set<unsigned>();
+            }
+        }
+    }
+
+    inline std::set<unsigned> smt_siblings(unsigned cpu) {
+        return detail::sysfs_cpus(cpu, "topology/thread_siblings_list");
+    }
+
+    inline std::set<unsigned> l3_neighbours(unsigned cpu) {
+        return detail::sysfs_cpus(cpu, "cache/index3/shared_cpu_list");
+    }
+
+    enum isolation { isolate_none, isolate_smt, isolate_l3 };
+
+    inline const char * name(isolation i) {
+        static const char * names[] = { "none", "smt", "l3" };
+        return names[i];
+    }
+
+    inline bool parse(const std::string & str, isolation & res) {
+        if (str == "none") res = isolate_none;
+        else if (str == "smt") res = isolate_smt;
+        else if (str == "l3") res = isolate_l3;
+        else return false;
+        return true;
+    }
+
+    // Keeps cpus in order, dropping each one that shares a physical core
+    // (smt) or an L3 cache (l3) with a cpu already kept
+    inline std::vector<unsigned> isolate(const std::vector<unsigned> & cpus, isolation level, 
+                                         std::vector<unsigned> * dropped = nullptr) {
+        std::vector<unsigned> res;
+        std::set<unsigned> taken;
+        for (auto cpu : cpus) {
+            if (std::find(std::begin(res), std::end(res), cpu) != std::end(res)) continue;
+            if (taken.count(cpu)) {
+                if (dropped) dropped->push_back(cpu);
+                continue;
+            }
+            res.push_back(cpu);
+            taken.insert(cpu);
+            if (level == isolate_none) continue;
+            auto shared = level == isolate_l3 ? l3_neighbours(cpu) : smt_siblings(cpu);
+            taken.insert(std::begin(shared), std::end(shared));
+        }
+        return res;
+    }
+
+    // Runs body(thread) on n threads, thread i pinned to cpus[i % cpus.size()],
+    // and joins them. The caller synchronizes with the bodies through its own
+    // barriers.
+    class thread_team {
+    public:
+        thread_team(unsigned n, const std::vector<unsigned> & cpus, std::function<void(unsigned)> body) {
+            threads_.reserve(n);
+            for (auto i = 0u; i < n; i++)
+                threads_.emplace_back([=] {
+                            if (!cpus.empty()) pin_thread(cpus[i % cpus.size()]);
+                            body(i);
+                        });
+        }
+
+        ~thread_team() {
+            for (auto & t : threads_) t.join();
+        }
+
+        thread_team(const thread_team &) = delete;
+        thread_team & operator=(const thread_team &) = delete;
+
+    private:
+        std::vector<std::thread> threads_;
+    };
+}
+
+#endif // MBM_THREADS_HPP_
@@ -0,0 +1,163 @@
+// =====================================================================================
+// 
+//       Filename:  types.hpp
+// 
+//    Description:  Typelists and the names of their types
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 09:12:40 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+#ifndef MBM_TYPES_HPP_
+#define MBM_TYPES_HPP_
+
+#include <cxxabi.h>
+
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace mbm {
+    // A list of types a fixture template is instantiated over, see
+    // easy_init::each
+    template<typename... T>
+    struct types { };
+
+    // A compile-time value list, e.g. btree node sizes, as a typelist of
+    // std::integral_constant
+    template<typename T, T... V>
+    using constants = types<std::integral_constant<T, V>...>;
+
+    namespace detail {
+        inline void replace_all(std::string & str, const std::string & from, const std::string & to) {
+            for (auto pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos + to.size()))
+                str.replace(pos, from.size(), to);
+        }
+
+        // Removes the template arguments starting with arg, through the
+        // matching closing bracket
+        inline void drop_args(std::string & str, const std::string & arg) {
+            for (auto pos = str.find(arg); pos != std::string::npos; pos = str.find(arg, pos)) {
+                auto end = pos + arg.size();
+                for (auto depth = 1; depth && end < str.size(); end++) 
+                    depth += str[end] == '<' ? 1 : str[end] == '>' ? -1 : 0;
+                str.erase(pos, end - pos);
+            }
+        }
+
+        // Without the standard default arguments, std::set<int> rather than
+        // std::set<int, std::less<int>, std::allocator<int> >
+        inline std::string demangle(const char * name) {
+            auto status = 0;
+            auto res = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+            if (status) return name;
+            std::string str(res);
+            std::free(res);
+            replace_all(str, "std::__cxx11::", "std::");
+            replace_all(str, "std::basic_string<char, std::char_traits<char>, std::allocator<char> >", "std::string");
+            for (auto arg : { ", std::less<", ", std::hash<", ", std::equal_to<", ", std::allocator<", ", std::char_traits<" })
+                drop_args(str, arg);
+            replace_all(str, " >", ">");
+            return str;
+        }
+    }
+
+    // The name of a type in derived fixture names, the demangled type
+    // unless specialized
+    template<typename T>
+    struct type_name {
+        static std::string get() { return detail::demangle(typeid(T).name()); }
+    };
+
+    template<typename T, T V>
+    struct type_name<std::integral_constant<T, V>> {
+        static std::string get() { return std::to_string(V); }
+    };
+
+    namespace detail {
+        template<typename A, typename B> struct concat;
+
+        template<typename... A, typename... B>
+        struct concat<types<A...>, types<B...>> { typedef types<A..., B...> type; };
+
+        // One combination extended by each type of a list in turn
+        template<typename Combo, typename List> struct extend;
+
+        template<typename... T, typename... U>
+        struct extend<types<T...>, types<U...>> { typedef types<types<T..., U>...> type; };
+
+        template<typename Combos, typename List> struct extend_all;
+
+        template<typename List>
+        struct extend_all<types<>, List> { typedef types<> type; };
+
+        template<typename C, typename... Cs, typename List>
+        struct extend_all<types<C, Cs...>, List> {
+            typedef typename concat<typename extend<C, List>::type, typename extend_all<types<Cs...>, List>::type>::type type;
+        };
+
+        template<typename Combos, typename... Lists>
+        struct product_of { typedef Combos type; };
+
+        template<typename Combos, typename L, typename... Ls>
+        struct product_of<Combos, L, Ls...> : product_of<typename extend_all<Combos, L>::type, Ls...> { };
+
+        // Every combination of one type from each list, as types<...>, the
+        // last list varying fastest
+        template<typename... Lists>
+        struct product : product_of<types<types<>>, Lists...> { };
+
+        template<template<typename...> class F, typename Combo> struct apply;
+
+        template<template<typename...> class F, typename... T>
+        struct apply<F, types<T...>> { 
+            typedef F<T...> type; 
+
+            static std::string name(const std::string & prefix) {
+                std::vector<std::string> names { type_name<T>::get()... };
+                std::string res;
+                for (const auto & n : names) res += (res.empty() ? "" : ",") + n;
+                return prefix + "<" + res + ">";
+            }
+        };
+
+        // f.template operator()<C>() for each combination C of a product
+        template<typename Combos> struct for_each_type;
+
+        template<>
+        struct for_each_type<types<>> {
+            template<typename F> static void call(F &) { }
+        };
+
+        template<typename C, typename... Cs>
+        struct for_each_type<types<C, Cs...>> {
+            template<typename F> 
+            static void call(F & f) { 
+                f.template operator()<C>();
+                for_each_type<types<Cs...>>::call(f);
+            }
+        };
+    }
+}
+
+#endif // MBM_TYPES_HPP_
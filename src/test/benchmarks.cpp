@@ -56,22 +56,19 @@ int main(int argc, char **argv) {
 //            ("const str ref", [] { return new cr::ref_str_fixture(); }, counts);
 
 
-        auto words = maps::read_words();        
-        suite.add("maps and sets")
-            ("insert - sorted vector", [&] { return new maps::vec_insert_fixture(words); }, counts)
-            ("insert - sorted vector (resort each)", [&] { return new maps::vec_insert_fixture_sorteach(words); }, counts)
-            ("insert - multiset", [&] { return new maps::multiset_insert_fixture(words); }, counts)
-            ("insert - btree multiset", [&] { return new maps::btree_multiset_insert_fixture(words); }, counts)
-            ("range - btree set", [&] { return new maps::btree_set_range_fixture(words); }, counts)
-            ("range - sorted vector", [&] { return new maps::vec_range_fixture(words); }, counts)
-            ("range - STL set", [&] { return new maps::set_range_fixture(words); }, counts)
-            ("lookup - btree set", [&] { return new maps::btree_set_fixture(words); }, counts)
-            ("lookup - sorted vector", [&] { return new maps::vec_fixture(words); }, counts)
-            ("lookup - STL set", [&] { return new maps::set_fixture(words); }, counts)
-            ("lookup - STL unordered set", [&] { return new maps::unordered_set_fixture(words); }, counts);
+        auto words = suite.datasets.add("words", [] { return mbm::read_lines("words.txt"); });
+        suite.add("maps and sets").uses(words)
+            ("insert<sorted vector>", [=] { return new maps::vec_insert_fixture(words); }, counts)
+            ("insert<sorted vector, resort each>", [=] { return new maps::vec_insert_fixture_sorteach(words); }, counts)
+            ("range<sorted vector>", [=] { return new maps::vec_range_fixture(words); }, counts)
+            ("lookup<sorted vector>", [=] { return new maps::vec_fixture(words); }, counts)
+            .each<maps::multiset_insert_fixture_t, maps::multisets>("insert", counts, words)
+            .each<maps::set_range_fixture_t, maps::ordered_sets>("range", counts, words)
+            .each<maps::set_fixture_t, maps::sets>("lookup", counts, words)
+            .tolerance<maps::set_fixture_t, std::unordered_set<std::string>>("lookup", 0.10);
 
         suite.parse_cmdline_opts(argc, argv);
-        suite.run();
+        if (suite.run()) return 2;
     } catch (const mbm::usage_error & e) {
         std::string what(e.what());
         if (!what.empty())
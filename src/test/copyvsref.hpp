@@ -66,12 +66,14 @@ struct fixture_state {
     }
 };
 
-struct copy_fixture : mbm::fixture { 
+struct copy_fixture : mbm::table_fixture<int> { 
     fixture_state state;
-    virtual void setup(const boost::any & v) {
-        state.init(boost::any_cast<int>(v));
+    virtual void setup(const int & v) {
+        state.init(v);
     }
 
+    virtual bool batchable() const { return false; }  // appends to state.res
+
     virtual void go() {
         std::for_each(std::begin(state.data), std::end(state.data),
                 [&](rect r) {
@@ -80,12 +82,14 @@ struct copy_fixture : mbm::fixture {
     }
 };
 
-struct ref_fixture : mbm::fixture { 
+struct ref_fixture : mbm::table_fixture<int> { 
     fixture_state state;
-    virtual void setup(const boost::any & v) {
-        state.init(boost::any_cast<int>(v));
+    virtual void setup(const int & v) {
+        state.init(v);
     }
 
+    virtual bool batchable() const { return false; }  // appends to state.res
+
     virtual void go() {
         std::for_each(std::begin(state.data), std::end(state.data),
                 [&](const rect & r) {
@@ -120,17 +124,19 @@ struct str_fixture_state {
     }
 };
 
-struct copy_str_fixture : mbm::fixture {
+struct copy_str_fixture : mbm::table_fixture<int> {
     str_fixture_state state;
     
     static size_t fn(const str_fixture_state::array_t & r) {
         return std::accumulate(std::begin(r), std::end(r), 0u);
     }
 
-    virtual void setup(const boost::any & v) {
-        state.init(boost::any_cast<int>(v));
+    virtual void setup(const int & v) {
+        state.init(v);
     }
 
+    virtual bool batchable() const { return false; }  // appends to state.res
+
     virtual void go() {
         std::for_each(std::begin(state.data), std::end(state.data),
                 [&](str_fixture_state::array_t r) {
@@ -140,17 +146,19 @@ struct copy_str_fixture : mbm::fixture {
 
 };
 
-struct ref_str_fixture : mbm::fixture {
+struct ref_str_fixture : mbm::table_fixture<int> {
     str_fixture_state state;
 
     static size_t fn(const str_fixture_state::array_t & r) {
         return std::accumulate(std::begin(r), std::end(r), 0u);
     }
     
-    virtual void setup(const boost::any & v) {
-        state.init(boost::any_cast<int>(v));
+    virtual void setup(const int & v) {
+        state.init(v);
     }
 
+    virtual bool batchable() const { return false; }  // appends to state.res
+
     virtual void go() {
         std::for_each(std::begin(state.data), std::end(state.data),
                 [&](const str_fixture_state::array_t & r) {
@@ -51,10 +51,10 @@ struct fixture_state {
     }
 };
 
-struct list_fixture : mbm::fixture { 
+struct list_fixture : mbm::table_fixture<int> { 
     fixture_state state;
-    virtual void setup(const boost::any & v) {
-        state.init(boost::any_cast<int>(v));
+    virtual void setup(const int & v) {
+        state.init(v);
     }
 
     virtual void go() {
@@ -72,10 +72,10 @@ struct list_fixture : mbm::fixture {
     }
 };
 
-struct vect_fixture : mbm::fixture { 
+struct vect_fixture : mbm::table_fixture<int> { 
     fixture_state state;
-    virtual void setup(const boost::any & v) {
-        state.init(boost::any_cast<int>(v));
+    virtual void setup(const int & v) {
+        state.init(v);
     }
 
     virtual void go() {
@@ -31,7 +31,6 @@
 #include <cpp-btree/btree_set.h>
 
 #include <mbm/mbm.hpp>
-#include <array>
 #include <vector>
 #include <set>
 #include <unordered_set>
@@ -39,29 +38,19 @@
 #include <algorithm>
 #include <random>
 #include <iostream>
-#include <fstream>
 
 namespace maps {
     typedef std::vector<std::string> string_vec;
-    string_vec read_words(const std::string & fname = "words.txt") {
-        std::ifstream stm(fname);
-        std::array<char, 1024> buf;
-        string_vec res;
-        while (stm.getline(buf.data(), buf.size())) {
-           res.emplace_back(buf.data()); 
-        }
-        return res;
-    }
+    typedef mbm::dataset<mbm::text> word_data;
 
-    struct vec_insert_fixture : mbm::fixture {
-        string_vec words;
+    struct vec_insert_fixture : mbm::table_fixture<int> {
+        word_data::pointer text;
+        mbm::span<mbm::string_view> words;
         std::vector<int> data;
 
-        vec_insert_fixture(const string_vec & words) : words(words) { }
-
-        virtual void setup(const boost::any & v) {
-            auto n = boost::any_cast<int>(v);
+        vec_insert_fixture(const word_data & source) : text(source.get()), words(text->lines()) { }
 
+        virtual void setup(const int & n) {
             std::random_device rd;
             std::default_random_engine e(rd());
 
@@ -72,24 +61,26 @@ namespace maps {
                     [&] { return uniform_dist(e);});
         }
 
+        virtual double items() const { return data.size(); }
+
         virtual void go() {
             string_vec res;
 
             std::transform(std::begin(data), std::end(data), std::inserter(res, std::end(res)),
-                    [&] (int i) { return words[i]; });
+                    [&] (int i) { return words[i].to_string(); });
             std::sort(std::begin(res), std::end(res));
             result(&res);
         }
     };
 
     struct vec_insert_fixture_sorteach : vec_insert_fixture {
-        vec_insert_fixture_sorteach(const string_vec & words) : vec_insert_fixture(words) { }
+        vec_insert_fixture_sorteach(const word_data & words) : vec_insert_fixture(words) { }
         virtual void go() {
             string_vec res;
 
             std::for_each(std::begin(data), std::end(data), 
                     [&] (int i) { 
-                        res.emplace_back(words[i]);
+                        res.emplace_back(words[i].to_string());
                         if (i % 10 == 0) 
                             std::sort(std::begin(res), std::end(res));
                      });
@@ -99,27 +90,26 @@ namespace maps {
 
     template<typename T>
     struct multiset_insert_fixture_t : vec_insert_fixture {
-        multiset_insert_fixture_t(const string_vec & words) : vec_insert_fixture(words) { }
+        multiset_insert_fixture_t(const word_data & words) : vec_insert_fixture(words) { }
 
         virtual void go() {
             T res;
 
             std::transform(std::begin(data), std::end(data), std::inserter(res, std::end(res)),
-                    [&] (int i) { return words[i]; });
+                    [&] (int i) { return words[i].to_string(); });
             result(&res);
         }
     };
 
     typedef std::pair<std::string, std::string> string_pair;
-    struct vec_range_fixture : mbm::fixture {
-        string_vec words;
+    struct vec_range_fixture : mbm::table_fixture<int> {
+        word_data::pointer text;
+        mbm::span<mbm::string_view> words;
         std::vector<string_pair> data;
 
-        vec_range_fixture(const string_vec & words) : words(words) { }
+        vec_range_fixture(const word_data & source) : text(source.get()), words(text->lines()) { }
 
-        virtual void setup(const boost::any & v) {
-            auto n = boost::any_cast<int>(v);
-            
+        virtual void setup(const int & n) {
             std::random_device rd;
             std::default_random_engine e(rd());
 
@@ -130,13 +120,15 @@ namespace maps {
                     [&] { 
                         auto ix1 = uniform_dist(e);
                         auto ix2 = uniform_dist(e);
-                        auto k1 = words[ix1];
-                        auto k2 = words[ix2];
+                        auto k1 = words[ix1].to_string();
+                        auto k2 = words[ix2].to_string();
 
                         return k1 < k2 ? std::make_pair(k1, k2) : std::make_pair(k2, k1);
                     });
         }
 
+        virtual double items() const { return data.size(); }
+
         virtual void go() {
             auto find_ct = 0;
             std::for_each(std::begin(data), std::end(data),
@@ -149,15 +141,14 @@ namespace maps {
         }
     };
 
-    struct vec_fixture : mbm::fixture {
-        string_vec words;
+    struct vec_fixture : mbm::table_fixture<int> {
+        word_data::pointer text;
+        mbm::span<mbm::string_view> words;
         string_vec data;
 
-        vec_fixture(const string_vec & words) : words(words) { }
-
-        virtual void setup(const boost::any & v) {
-            auto n = boost::any_cast<int>(v);
+        vec_fixture(const word_data & source) : text(source.get()), words(text->lines()) { }
 
+        virtual void setup(const int & n) {
             std::random_device rd;
             std::default_random_engine e(rd());
 
@@ -167,10 +158,12 @@ namespace maps {
             std::generate_n(std::inserter(data, std::end(data)), n,
                     [&] { 
                         auto ix = uniform_dist(e);
-                        return words[ix]; 
+                        return words[ix].to_string(); 
                     });
         }
 
+        virtual double items() const { return data.size(); }
+
         virtual void go() {
             auto find_ct = 0;
             std::for_each(std::begin(data), std::end(data),
@@ -186,11 +179,11 @@ namespace maps {
     struct set_fixture_t : vec_fixture {
         T word_set;
 
-        set_fixture_t(const string_vec & words) : vec_fixture(words) { }
+        set_fixture_t(const word_data & words) : vec_fixture(words) { }
 
-        virtual void setup (const boost::any & v) {
+        virtual void setup(const int & v) {
             vec_fixture::setup(v);
-            word_set.insert(std::begin(words), std::end(words));
+            for (const auto & word : words) word_set.insert(word.to_string());
         }
 
         virtual void go() {
@@ -206,11 +199,11 @@ namespace maps {
     struct set_range_fixture_t : vec_range_fixture {
         T word_set;
 
-        set_range_fixture_t(const string_vec & words) : vec_range_fixture(words) { }
+        set_range_fixture_t(const word_data & words) : vec_range_fixture(words) { }
 
-        virtual void setup (const boost::any & v) {
+        virtual void setup(const int & v) {
             vec_range_fixture::setup(v);
-            word_set.insert(std::begin(words), std::end(words));
+            for (const auto & word : words) word_set.insert(word.to_string());
         }
 
         struct func {
@@ -232,12 +225,27 @@ namespace maps {
         }
     };
 
-    using multiset_insert_fixture = multiset_insert_fixture_t<std::multiset<std::string>>;
-    using btree_multiset_insert_fixture = multiset_insert_fixture_t<btree::btree_multiset<std::string>>;
-    using set_fixture = set_fixture_t<std::set<std::string>>;
-    using unordered_set_fixture = set_fixture_t<std::unordered_set<std::string>>;
-    using btree_set_fixture = set_fixture_t<btree::btree_set<std::string>>;
-    using set_range_fixture = set_range_fixture_t<std::set<std::string>>;
-    using btree_set_range_fixture = set_range_fixture_t<btree::btree_set<std::string>>;
+    using multisets = mbm::types<std::multiset<std::string>, btree::btree_multiset<std::string>>;
+    using ordered_sets = mbm::types<std::set<std::string>, btree::btree_set<std::string>>;
+    using sets = mbm::types<std::set<std::string>, std::unordered_set<std::string>, btree::btree_set<std::string>>;
+}
+
+// Short names that do not depend on the standard library or btree defaults,
+// as they key saved baselines
+namespace mbm {
+    template<typename... T>
+    struct type_name<std::set<T...>> { static std::string get() { return "std::set"; } };
+
+    template<typename... T>
+    struct type_name<std::multiset<T...>> { static std::string get() { return "std::multiset"; } };
+
+    template<typename... T>
+    struct type_name<std::unordered_set<T...>> { static std::string get() { return "std::unordered_set"; } };
+
+    template<typename K, typename C, typename A, int N>
+    struct type_name<btree::btree_set<K, C, A, N>> { static std::string get() { return "btree_set"; } };
+
+    template<typename K, typename C, typename A, int N>
+    struct type_name<btree::btree_multiset<K, C, A, N>> { static std::string get() { return "btree_multiset"; } };
 }
 #endif // MBM_MAPS_HPP_
@@ -61,24 +61,28 @@ int compf(const void * v1, const void * v2) {
     return 0;
 }
 
-struct qsort_fixture : mbm::fixture {
+struct qsort_fixture : mbm::table_fixture<int> {
     fixture_state state;
-    virtual void setup(const boost::any & v) { 
-        state.init(boost::any_cast<int>(v)); 
+    virtual void setup(const int & v) { 
+        state.init(v); 
     }
 
+    virtual bool batchable() const { return false; }  // sorts in place
+
     virtual void go() {
         qsort(state.data.data(), state.noents, sizeof(double), compf);
         result(&state);
     }
 };
 
-struct sort_fixture : mbm::fixture {
+struct sort_fixture : mbm::table_fixture<int> {
     fixture_state state;
-    virtual void setup(const boost::any & v) { 
-        state.init(boost::any_cast<int>(v)); 
+    virtual void setup(const int & v) { 
+        state.init(v); 
     }
 
+    virtual bool batchable() const { return false; }  // sorts in place
+
     virtual void go() {
         std::sort(std::begin(state.data), std::end(state.data));
         result(&state);
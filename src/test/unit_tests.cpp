@@ -0,0 +1,228 @@
+// =====================================================================================
+// 
+//       Filename:  unit_tests.cpp
+// 
+//    Description:  Checks of the statistics and histograms against known values
+// 
+//        Version:  1.0
+//        Created:  10/18/2026 09:14:27 PM
+//       Revision:  none
+//       Compiler:  g++ 4.7 or later
+// 
+//         Author:  Thomas Rodgers (twr), rodgert@twrodgers.com
+//
+//	Copyright (c) 2026, Thomas Rodgers
+//
+// 	Licensed under the Apache License, Version 2.0 (the "License");
+//	you may not use this file except in compliance with the License.
+//	You may obtain a copy of the License at
+//
+//	   http://www.apache.org/licenses/LICENSE-2.0
+//
+//	Unless required by applicable law or agreed to in writing, software
+//	distributed under the License is distributed on an "AS IS" BASIS,
+//	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//	See the License for the specific language governing permissions and
+//	limitations under the License.
+// =====================================================================================
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <mbm/stats.hpp>
+#include <mbm/histogram.hpp>
+#include <mbm/suite.hpp>
+
+namespace {
+    int failures = 0;
+
+    void check_near(const char * what, double actual, double expected, double tol = 1e-9) {
+        if (std::fabs(actual - expected) <= tol) return;
+        std::cerr << what << ": expected " << expected << ", got " << actual << std::endl;
+        failures++;
+    }
+
+    // Exact P(X >= m) for X ~ Binomial(n, p), summed in log space
+    double binomial_tail(size_t n, double p, size_t m) {
+        auto res = 0.0;
+        for (auto k = m; k <= n; k++)
+            res += std::exp(std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0) 
+                    + k * std::log(p) + (n - k) * std::log1p(-p));
+        return res;
+    }
+
+    std::vector<double> iota(int first, int last) {
+        std::vector<double> res;
+        for (auto i = first; i <= last; i++) res.push_back(i);
+        return res;
+    }
+
+    void test_quantile() {
+        // R: quantile(1:10, c(0, .25, .5, .9, 1))
+        auto v = iota(1, 10);
+        check_near("quantile 0", mbm::stats::quantile(v, 0.0), 1.0);
+        check_near("quantile .25", mbm::stats::quantile(v, 0.25), 3.25);
+        check_near("quantile .5", mbm::stats::quantile(v, 0.5), 5.5);
+        check_near("quantile .9", mbm::stats::quantile(v, 0.9), 9.1);
+        check_near("quantile 1", mbm::stats::quantile(v, 1.0), 10.0);
+    }
+
+    void test_mad() {
+        // R: mad(x, constant = 1)
+        std::vector<double> odd = { 1, 1, 2, 2, 4, 6, 9 };
+        check_near("mad odd", mbm::stats::median_abs_deviation(odd, 2.0), 1.0);
+        std::vector<double> even = { 1, 2, 3, 4, 10, 20 };
+        check_near("mad even", mbm::stats::median_abs_deviation(even, 3.5), 2.0);
+    }
+
+    void test_binomial() {
+        check_near("binomial exact", mbm::stats::binomial_upper_tail(10, 0.5, 8), 56.0 / 1024.0);
+        check_near("binomial m = 0", mbm::stats::binomial_upper_tail(10, 0.5, 0), 1.0);
+        check_near("binomial m > n", mbm::stats::binomial_upper_tail(10, 0.5, 11), 0.0);
+        // Either side of the switch to the normal approximation
+        for (size_t n : { 200, 201, 400 })
+            check_near("binomial approximation", mbm::stats::binomial_upper_tail(n, 0.5, n / 2 + n / 20), 
+                    binomial_tail(n, 0.5, n / 2 + n / 20), 1e-3);
+    }
+
+    void test_summarize() {
+        auto v = iota(1, 10);
+        auto s = mbm::stats::summarize(v);
+        check_near("n", s.n, 10);
+        check_near("min", s.min, 1.0);
+        check_near("max", s.max, 10.0);
+        check_near("median", s.median, 5.5);
+        check_near("mad", s.mad, 2.5);
+        check_near("mean", s.mean, 5.5);
+        check_near("stddev", s.stddev, std::sqrt(8.25));
+        check_near("trimmed mean", s.trimmed_mean, 5.5);
+        // P(median* <= x(r)) = P(Binomial(10, r / 10) >= 5) first reaches
+        // .025 at r = 2 and .975 at r = 8
+        check_near("median ci low", s.ci_low, 2.0);
+        check_near("median ci high", s.ci_high, 8.0);
+        check_near("outliers", s.mild() + s.severe(), 0);
+
+        // q1 = 3.5, q3 = 8.5, so 100 is beyond the severe fence of 23.5
+        v.push_back(100.0);
+        s = mbm::stats::summarize(v);
+        check_near("severe high", s.severe_high, 1);
+        check_near("excluded", s.excluded, 1);
+        check_near("mean without outlier", s.mean, 5.5);
+    }
+
+    void test_mann_whitney() {
+        // R: wilcox.test(a, b, exact = FALSE)$p.value
+        check_near("mann whitney", mbm::stats::mann_whitney(iota(1, 5), iota(6, 10)), 0.012185780, 1e-8);
+        check_near("mann whitney ties", mbm::stats::mann_whitney({ 1, 2, 2, 3 }, { 2, 3, 4, 4 }), 0.134169180, 1e-8);
+        check_near("mann whitney same", mbm::stats::mann_whitney({ 1, 1, 1 }, { 1, 1 }), 1.0);
+        check_near("mann whitney empty", mbm::stats::mann_whitney({}, { 1, 2 }), 1.0);
+    }
+
+    void test_histogram_precision() {
+        // Values below 2^k are exact, above that a value comes back as its
+        // bucket midpoint, within 10^-digits of it
+        const uint64_t highest = uint64_t(1) << 40;
+        for (auto digits = 1u; digits <= 5; digits++) {
+            auto bound = std::pow(10.0, -static_cast<double>(digits));
+            for (uint64_t v = 1; v < highest; v = v * 3 / 2 + 1) {
+                mbm::histogram h(digits);
+                h.record(0);
+                h.record(v);
+                h.record(highest);
+                check_near("histogram round trip", h.at_rank(1), v, v * bound);
+            }
+        }
+        mbm::histogram h(3);
+        h.record(1777);
+        check_near("histogram exact below 2^k", h.at_rank(0), 1777);
+    }
+
+    void test_histogram_at_rank() {
+        mbm::histogram h(3);
+        for (auto v = 1u; v <= 100; v++) h.record(v);
+        check_near("at_rank first", h.at_rank(0), 1);
+        check_near("at_rank middle", h.at_rank(49), 50);
+        check_near("at_rank last", h.at_rank(99), 100);
+        check_near("at_rank past the end", h.at_rank(1000), 100);
+        check_near("histogram quantile", h.quantile(0.25), 25.75);
+
+        mbm::histogram r(3);
+        for (auto v : { 5, 5, 5, 7, 7 }) r.record(v);
+        check_near("at_rank repeated", r.at_rank(2), 5);
+        check_near("at_rank next bucket", r.at_rank(3), 7);
+
+        // Reserved buckets stay empty
+        mbm::histogram z(3);
+        z.reserve(uint64_t(1) << 30);
+        z.record(5);
+        check_near("reserved count", z.count(), 1);
+        check_near("reserved at_rank", z.at_rank(0), 5);
+        check_near("reserved quantile", z.quantile(1.0), 5);
+    }
+
+    void test_histogram_merge() {
+        mbm::histogram a(3), b(3);
+        for (auto v = 1u; v <= 1000; v++) a.record(v);
+        for (auto v = 1001u; v <= 100000; v++) b.record(v);
+        mbm::histogram m;
+        m.merge(a);
+        m.merge(b);
+        check_near("merged count", m.count(), 100000);
+        check_near("merged min", m.min(), 1);
+        check_near("merged max", m.max(), 100000);
+        check_near("merged mean", m.mean(), 50000.5);
+        check_near("merged median", m.quantile(0.5), 50000.5, 50.0);
+        check_near("merged low rank", m.at_rank(499), 500);
+
+        auto threw = false;
+        try {
+            m.merge(mbm::histogram(2));
+        } catch (const std::invalid_argument &) {
+            threw = true;
+        }
+        check_near("merge of different precision throws", threw, true);
+    }
+
+    void test_reservoir() {
+        typedef mbm::detail::fixture_runner::recorder recorder;
+        const uint64_t runs = 100000;
+
+        mbm::detail::run_opts opts(runs, mbm::timer::clock_kind);
+        mbm::detail::run_res_t all;
+        recorder keep(opts, all);
+        for (uint64_t t = 0; t < 100; t++) keep(t);
+        check_near("samples kept without a histogram", all.samples.size(), 100);
+
+        opts.histogram_digits = 3;
+        mbm::detail::run_res_t res;
+        recorder rec(opts, res);
+        for (uint64_t t = 0; t < runs; t++) rec(t);
+        check_near("histogram count", res.hist.count(), runs);
+        check_near("reservoir size", res.samples.size(), recorder::reservoir);
+        // A uniform sample of 0..runs-1 has mean runs / 2 with a standard
+        // error of about 290
+        auto mean = std::accumulate(std::begin(res.samples), std::end(res.samples), 0.0) / res.samples.size();
+        check_near("reservoir mean", mean, (runs - 1) / 2.0, 1500.0);
+        auto late = std::count_if(std::begin(res.samples), std::end(res.samples), 
+                [runs](uint64_t t) { return t >= runs / 2; });
+        check_near("reservoir late half", late, recorder::reservoir / 2.0, 250.0);
+    }
+}
+
+int main() {
+    test_quantile();
+    test_mad();
+    test_binomial();
+    test_summarize();
+    test_mann_whitney();
+    test_histogram_precision();
+    test_histogram_at_rank();
+    test_histogram_merge();
+    test_reservoir();
+    if (failures) std::cerr << failures << " checks failed" << std::endl;
+    return failures ? 1 : 0;
+}